@@ -174,16 +174,25 @@ void free_ea_mt(ea_mt_codec_data *data, int channels);
 #ifdef VGM_USE_VORBIS
 /* ogg_vorbis_decoder */
 void decode_ogg_vorbis(ogg_vorbis_codec_data * data, sample * outbuf, int32_t samples_to_do, int channels);
+void decode_ogg_vorbis_fmt(ogg_vorbis_codec_data * data, void * outbuf, sample_fmt_t fmt, int32_t samples_to_do, int channels);
+int32_t decode_ogg_vorbis_to_end(ogg_vorbis_codec_data * data, sample_fmt_t fmt, int channels, int32_t max_samples, vgmstream_sink_t sink, void * user_data);
 void reset_ogg_vorbis(VGMSTREAM *vgmstream);
 void seek_ogg_vorbis(VGMSTREAM *vgmstream, int32_t num_sample);
 void free_ogg_vorbis(ogg_vorbis_codec_data *data);
 
 /* vorbis_custom_decoder */
 vorbis_custom_codec_data *init_vorbis_custom(STREAMFILE *streamfile, off_t start_offset, vorbis_custom_t type, vorbis_custom_config * config);
+vorbis_custom_codec_data *init_vorbis_custom_headers(STREAMFILE *streamfile, off_t start_offset, vorbis_custom_t type, vorbis_custom_config * config);
 void decode_vorbis_custom(VGMSTREAM * vgmstream, sample * outbuf, int32_t samples_to_do, int channels);
+void decode_vorbis_custom_fmt(VGMSTREAM * vgmstream, void * outbuf, sample_fmt_t fmt, int32_t samples_to_do, int channels);
+int32_t decode_vorbis_custom_to_end(VGMSTREAM * vgmstream, sample_fmt_t fmt, int32_t max_samples, vgmstream_sink_t sink, void * user_data);
 void reset_vorbis_custom(VGMSTREAM *vgmstream);
 void seek_vorbis_custom(VGMSTREAM *vgmstream, int32_t num_sample);
 void free_vorbis_custom(vorbis_custom_codec_data *data);
+void vorbis_custom_set_cache_dir(const char * dir);
+int vorbis_custom_remux_ogg(VGMSTREAM * vgmstream, vgmstream_write_t write, void * user_data);
+int vorbis_custom_remux_ogg_fsb(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_config * config, int32_t num_samples, vgmstream_write_t write, void * user_data);
+int vorbis_custom_pack_wwise(STREAMFILE *streamFile, vgmstream_write_t write, void * user_data);
 #endif
 
 #ifdef VGM_USE_MPEG
@@ -340,5 +349,6 @@ typedef struct {
 
 int r_bits(vgm_bitstream * ib, int num_bits, uint32_t * value);
 int w_bits(vgm_bitstream * ob, int num_bits, uint32_t value);
+int copy_bits(vgm_bitstream * ob, vgm_bitstream * ib, size_t num_bits);
 
 #endif /*_CODING_H*/
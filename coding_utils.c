@@ -916,142 +916,167 @@ size_t atrac3plus_bytes_to_samples(size_t bytes, int full_block_align) {
 /* ******************************************** */
 
 
-/* Read bits (max 32) from buf and update the bit offset. Vorbis packs values in LSB order and byte by byte.
- * (ex. from 2 bytes 00100111 00000001 we can could read 4b=0111 and 6b=010010, 6b=remainder (second value is split into the 2nd byte) */
-static int r_bits_vorbis(vgm_bitstream * ib, int num_bits, uint32_t * value) {
-    off_t off, pos;
-    int i, bit_buf, bit_val;
-    if (num_bits == 0) return 1;
-    if (num_bits > 32 || num_bits < 0 || ib->b_off + num_bits > ib->bufsize*8) goto fail;
-
-    *value = 0; /* set all bits to 0 */
-    off = ib->b_off / 8; /* byte offset */
-    pos = ib->b_off % 8; /* bit sub-offset */
-    for (i = 0; i < num_bits; i++) {
-        bit_buf = (1U << pos) & 0xFF;   /* bit check for buf */
-        bit_val = (1U << i);            /* bit to set in value */
-
-        if (ib->buf[off] & bit_buf)     /* is bit in buf set? */
-            *value |= bit_val;          /* set bit */
-
-        pos++;                          /* new byte starts */
-        if (pos%8 == 0) {
-            pos = 0;
-            off++;
-        }
+/* Bits are handled a word at a time: up to 8 bytes around the current offset are loaded into a 64b
+ * accumulator (max 7 bit sub-offset + 57 bits fit), then values are shifted/masked in one go, rather
+ * than moving one bit per loop. b_off is still the only state, so callers may adjust it directly. */
+#define BITSTREAM_MAX_WORD_BITS 56 /* max bits moved per accumulator load (8 bytes minus sub-offset) */
+
+/* loads up to 8 bytes as a LE/BE word, zero-padding past the buffer end */
+static inline uint64_t load_word_le(const vgm_bitstream * bs, off_t off) {
+    uint64_t word = 0;
+    int i, bytes;
+
+    if (off + 8 <= bs->bufsize)
+        return (uint64_t)get_64bitLE(bs->buf + off);
+
+    bytes = bs->bufsize - off;
+    for (i = 0; i < bytes; i++) {
+        word |= (uint64_t)bs->buf[off + i] << (i*8);
     }
+    return word;
+}
+static inline uint64_t load_word_be(const vgm_bitstream * bs, off_t off) {
+    uint64_t word = 0;
+    int i, bytes;
 
-    ib->b_off += num_bits;
-    return 1;
-fail:
-    return 0;
+    if (off + 8 <= bs->bufsize)
+        return (uint64_t)get_64bitBE(bs->buf + off);
+
+    bytes = bs->bufsize - off;
+    for (i = 0; i < bytes; i++) {
+        word |= (uint64_t)bs->buf[off + i] << (56 - i*8);
+    }
+    return word;
 }
 
-/* Write bits (max 32) to buf and update the bit offset. Vorbis packs values in LSB order and byte by byte.
- * (ex. writing 1101011010 from b_off 2 we get 01101011 00001101 (value split, and 11 in the first byte skipped)*/
-static int w_bits_vorbis(vgm_bitstream * ob, int num_bits, uint32_t value) {
-    off_t off, pos;
-    int i, bit_val, bit_buf;
-    if (num_bits == 0) return 1;
-    if (num_bits > 32 || num_bits < 0 || ob->b_off + num_bits > ob->bufsize*8) goto fail;
+/* stores only the bytes touched by a write, so nothing past them (or past bufsize) is modified */
+static inline void store_word_le(vgm_bitstream * bs, off_t off, uint64_t word, int bytes) {
+    int i;
+    for (i = 0; i < bytes; i++) {
+        bs->buf[off + i] = (uint8_t)(word >> (i*8));
+    }
+}
+static inline void store_word_be(vgm_bitstream * bs, off_t off, uint64_t word, int bytes) {
+    int i;
+    for (i = 0; i < bytes; i++) {
+        bs->buf[off + i] = (uint8_t)(word >> (56 - i*8));
+    }
+}
 
+static inline uint64_t bits_mask(int num_bits) {
+    return num_bits >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << num_bits) - 1);
+}
 
-    off = ob->b_off / 8; /* byte offset */
-    pos = ob->b_off % 8; /* bit sub-offset */
-    for (i = 0; i < num_bits; i++) {
-        bit_val = (1U << i);            /* bit check for value */
-        bit_buf = (1U << pos) & 0xFF;   /* bit to set in buf */
 
-        if (value & bit_val)            /* is bit in val set? */
-            ob->buf[off] |= bit_buf;    /* set bit */
-        else
-            ob->buf[off] &= ~bit_buf;   /* unset bit */
+/* Read bits (max 56) from buf and update the bit offset. Vorbis packs values in LSB order and byte by byte.
+ * (ex. from 2 bytes 00100111 00000001 we can could read 4b=0111 and 6b=010010, 6b=remainder (second value is split into the 2nd byte) */
+static int r_word_vorbis(vgm_bitstream * ib, int num_bits, uint64_t * value) {
+    off_t off = ib->b_off / 8; /* byte offset */
+    int pos = ib->b_off % 8; /* bit sub-offset */
 
-        pos++;                          /* new byte starts */
-        if (pos%8 == 0) {
-            pos = 0;
-            off++;
-        }
-    }
+    *value = (load_word_le(ib, off) >> pos) & bits_mask(num_bits);
 
-    ob->b_off += num_bits;
+    ib->b_off += num_bits;
     return 1;
-fail:
-    return 0;
 }
 
+/* Write bits (max 56) to buf and update the bit offset. Vorbis packs values in LSB order and byte by byte.
+ * (ex. writing 1101011010 from b_off 2 we get 01101011 00001101 (value split, and 11 in the first byte skipped)*/
+static int w_word_vorbis(vgm_bitstream * ob, int num_bits, uint64_t value) {
+    off_t off = ob->b_off / 8; /* byte offset */
+    int pos = ob->b_off % 8; /* bit sub-offset */
+    uint64_t word, mask;
 
-/* Read bits (max 32) from buf and update the bit offset. Order is BE (MSF). */
-static int r_bits_msf(vgm_bitstream * ib, int num_bits, uint32_t * value) {
-    off_t off, pos;
-    int i, bit_buf, bit_val;
-    if (num_bits == 0) return 1;
-    if (num_bits > 32 || num_bits < 0 || ib->b_off + num_bits > ib->bufsize*8) goto fail;
-
-    *value = 0; /* set all bits to 0 */
-    off = ib->b_off / 8; /* byte offset */
-    pos = ib->b_off % 8; /* bit sub-offset */
-    for (i = 0; i < num_bits; i++) {
-        bit_buf = (1U << (8-1-pos)) & 0xFF;   /* bit check for buf */
-        bit_val = (1U << (num_bits-1-i));     /* bit to set in value */
-
-        if (ib->buf[off] & bit_buf)         /* is bit in buf set? */
-            *value |= bit_val;              /* set bit */
-
-        pos++;
-        if (pos%8 == 0) {                   /* new byte starts */
-            pos = 0;
-            off++;
-        }
-    }
+    mask = bits_mask(num_bits) << pos;
+    word = load_word_le(ob, off);
+    word = (word & ~mask) | ((value << pos) & mask);
+    store_word_le(ob, off, word, (pos + num_bits + 7) / 8);
 
-    ib->b_off += num_bits;
+    ob->b_off += num_bits;
     return 1;
-fail:
-    return 0;
 }
 
-/* Write bits (max 32) to buf and update the bit offset. Order is BE (MSF). */
-static int w_bits_msf(vgm_bitstream * ob, int num_bits, uint32_t value) {
-    off_t off, pos;
-    int i, bit_val, bit_buf;
-    if (num_bits == 0) return 1;
-    if (num_bits > 32 || num_bits < 0 || ob->b_off + num_bits > ob->bufsize*8) goto fail;
+/* Read bits (max 56) from buf and update the bit offset. Order is BE (MSF). */
+static int r_word_msf(vgm_bitstream * ib, int num_bits, uint64_t * value) {
+    off_t off = ib->b_off / 8; /* byte offset */
+    int pos = ib->b_off % 8; /* bit sub-offset */
 
+    *value = (load_word_be(ib, off) >> (64 - pos - num_bits)) & bits_mask(num_bits);
 
-    off = ob->b_off / 8; /* byte offset */
-    pos = ob->b_off % 8; /* bit sub-offset */
-    for (i = 0; i < num_bits; i++) {
-        bit_val = (1U << (num_bits-1-i));     /* bit check for value */
-        bit_buf = (1U << (8-1-pos)) & 0xFF;   /* bit to set in buf */
+    ib->b_off += num_bits;
+    return 1;
+}
 
-        if (value & bit_val)                /* is bit in val set? */
-            ob->buf[off] |= bit_buf;        /* set bit */
-        else
-            ob->buf[off] &= ~bit_buf;       /* unset bit */
+/* Write bits (max 56) to buf and update the bit offset. Order is BE (MSF). */
+static int w_word_msf(vgm_bitstream * ob, int num_bits, uint64_t value) {
+    off_t off = ob->b_off / 8; /* byte offset */
+    int pos = ob->b_off % 8; /* bit sub-offset */
+    int shift = 64 - pos - num_bits;
+    uint64_t word, mask;
 
-        pos++;
-        if (pos%8 == 0) {                   /* new byte starts */
-            pos = 0;
-            off++;
-        }
-    }
+    mask = bits_mask(num_bits) << shift;
+    word = load_word_be(ob, off);
+    word = (word & ~mask) | ((value << shift) & mask);
+    store_word_be(ob, off, word, (pos + num_bits + 7) / 8);
 
     ob->b_off += num_bits;
     return 1;
-fail:
-    return 0;
 }
 
 int r_bits(vgm_bitstream * ib, int num_bits, uint32_t * value) {
+    uint64_t word = 0;
+    int ok;
+    if (num_bits == 0) return 1;
+    if (num_bits > 32 || num_bits < 0 || ib->b_off + num_bits > ib->bufsize*8) return 0;
+
     if (ib->mode == BITSTREAM_VORBIS)
-        return r_bits_vorbis(ib,num_bits,value);
+        ok = r_word_vorbis(ib,num_bits,&word);
     else
-        return r_bits_msf(ib,num_bits,value);
+        ok = r_word_msf(ib,num_bits,&word);
+    *value = (uint32_t)word;
+    return ok;
 }
 int w_bits(vgm_bitstream * ob, int num_bits, uint32_t value) {
+    if (num_bits == 0) return 1;
+    if (num_bits > 32 || num_bits < 0 || ob->b_off + num_bits > ob->bufsize*8) return 0;
+
     if (ob->mode == BITSTREAM_VORBIS)
-        return w_bits_vorbis(ob,num_bits,value);
+        return w_word_vorbis(ob,num_bits,value);
     else
-        return w_bits_msf(ob,num_bits,value);
+        return w_word_msf(ob,num_bits,value);
+}
+
+/* Copy bits from ib to ob (both at any bit offset) and update both offsets.
+ * Equivalent to a r_bits+w_bits loop, but moves up to 56 bits per step (or memcpy when byte-aligned). */
+int copy_bits(vgm_bitstream * ob, vgm_bitstream * ib, size_t num_bits) {
+    if (num_bits == 0) return 1;
+    if (ib->mode != ob->mode) return 0;
+    if (ib->b_off + num_bits > ib->bufsize*8 || ob->b_off + num_bits > ob->bufsize*8) return 0;
+
+    /* both aligned: bit order doesn't matter for full bytes */
+    if (ib->b_off % 8 == 0 && ob->b_off % 8 == 0) {
+        size_t bytes = num_bits / 8;
+
+        memmove(ob->buf + ob->b_off / 8, ib->buf + ib->b_off / 8, bytes);
+        ib->b_off += bytes * 8;
+        ob->b_off += bytes * 8;
+        num_bits -= bytes * 8;
+    }
+
+    while (num_bits > 0) {
+        uint64_t word = 0;
+        int bits = num_bits > BITSTREAM_MAX_WORD_BITS ? BITSTREAM_MAX_WORD_BITS : num_bits;
+
+        if (ib->mode == BITSTREAM_VORBIS) {
+            r_word_vorbis(ib, bits, &word);
+            w_word_vorbis(ob, bits, word);
+        }
+        else {
+            r_word_msf(ib, bits, &word);
+            w_word_msf(ob, bits, word);
+        }
+        num_bits -= bits;
+    }
+
+    return 1;
 }
@@ -10,12 +10,35 @@
  * Similar to interleave layout, but decodec samples are mixed from complete vgmstreams, each
  * with custom codecs and different number of channels, creating a single super-vgmstream.
  * Usually combined with custom streamfiles to handle data interleaved in weird ways. */
-void render_vgmstream_layered(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream) {
+void render_vgmstream_layered(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
     int samples_written = 0;
     layered_layout_data *data = vgmstream->layout_data;
-    sample interleave_buf[LAYER_BUF_SIZE*LAYER_MAX_CHANNELS];
+    int32_t interleave_buf[LAYER_BUF_SIZE*LAYER_MAX_CHANNELS]; /* big enough for any format */
+    size_t sample_size = get_sample_fmt_size(fmt);
 
 
+    /* planar: each layer renders its channels straight into the main buffers */
+    if (is_sample_fmt_planar(fmt)) {
+        void ** buffers = buffer;
+        void * layer_buf[LAYER_MAX_CHANNELS];
+        int layer, ch = 0;
+
+        for (layer = 0; layer < data->layer_count; layer++) {
+            int layer_ch;
+            int layer_channels = data->layers[layer]->channels;
+
+            for (layer_ch = 0; layer_ch < layer_channels; layer_ch++) {
+                layer_buf[layer_ch] = buffers[ch];
+                ch++;
+            }
+
+            render_vgmstream_fmt(layer_buf, fmt, sample_count, data->layers[layer]);
+        }
+
+        vgmstream->current_sample = data->layers[0]->current_sample; /* just in case it's used for info */
+        return;
+    }
+
     while (samples_written < sample_count) {
         int samples_to_do = LAYER_BUF_SIZE;
         int layer, ch = 0;
@@ -29,15 +52,18 @@ void render_vgmstream_layered(sample * buffer, int32_t sample_count, VGMSTREAM *
 
             /* each layer will handle its own looping internally */
 
-            render_vgmstream(interleave_buf, samples_to_do, data->layers[layer]);
+            render_vgmstream_fmt(interleave_buf, fmt, samples_to_do, data->layers[layer]);
 
-            /* mix layer samples to main samples */
+            /* mix layer samples to main samples (float is copied as 32-bit) */
             for (layer_ch = 0; layer_ch < layer_channels; layer_ch++) {
                 for (s = 0; s < samples_to_do; s++) {
                     size_t layer_sample = s*layer_channels + layer_ch;
                     size_t buffer_sample = (samples_written+s)*vgmstream->channels + ch;
 
-                    buffer[buffer_sample] = interleave_buf[layer_sample];
+                    if (sample_size == sizeof(sample))
+                        ((sample*)buffer)[buffer_sample] = ((sample*)interleave_buf)[layer_sample];
+                    else
+                        ((int32_t*)buffer)[buffer_sample] = interleave_buf[layer_sample];
                 }
                 ch++;
             }
@@ -50,17 +50,17 @@ void block_update_xa_aiff(off_t block_offset, VGMSTREAM * vgmstream);
 /* other layouts */
 void render_vgmstream_interleave(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
 
-void render_vgmstream_flat(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
+void render_vgmstream_flat(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream);
 
 void render_vgmstream_aix(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
 
-void render_vgmstream_segmented(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
+void render_vgmstream_segmented(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream);
 segmented_layout_data* init_layout_segmented(int segment_count);
 int setup_layout_segmented(segmented_layout_data* data);
 void free_layout_segmented(segmented_layout_data *data);
 void reset_layout_segmented(segmented_layout_data *data);
 
-void render_vgmstream_layered(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
+void render_vgmstream_layered(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream);
 layered_layout_data* init_layout_layered(int layer_count);
 int setup_layout_layered(layered_layout_data* data);
 void free_layout_layered(layered_layout_data *data);
@@ -1,9 +1,12 @@
 #include "coding.h"
 #include "util.h"
+#include "vorbis_custom_decoder.h"
 
 #ifdef VGM_USE_VORBIS
 #include <vorbis/vorbisfile.h>
 
+#define OGG_SINK_BUFFER_SAMPLES 4096 /* per channel, at least max blocksize/2 to pass a block at once */
+
 void decode_ogg_vorbis(ogg_vorbis_codec_data * data, sample * outbuf, int32_t samples_to_do, int channels) {
     int samples_done = 0;
     OggVorbis_File *ogg_vorbis_file = &data->ogg_vorbis_file;
@@ -20,6 +23,56 @@ void decode_ogg_vorbis(ogg_vorbis_codec_data * data, sample * outbuf, int32_t sa
     swap_samples_le(outbuf, samples_to_do*channels);
 }
 
+/* Same as decode_ogg_vorbis, but in any format. Other formats are made from libvorbis' float samples
+ * (interleaved 16-bit keeps using ov_read for the same output as before). */
+void decode_ogg_vorbis_fmt(ogg_vorbis_codec_data * data, void * outbuf, sample_fmt_t fmt, int32_t samples_to_do, int channels) {
+    int samples_done = 0;
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
+    OggVorbis_File *ogg_vorbis_file = &data->ogg_vorbis_file;
+
+    if (fmt == SAMPLE_FMT_S16) {
+        decode_ogg_vorbis(data, outbuf, samples_to_do, channels);
+        return;
+    }
+
+    do {
+        float **pcm;
+        long rc = ov_read_float(ogg_vorbis_file, &pcm, samples_to_do - samples_done, &data->bitstream);
+
+        if (rc <= 0) return;
+
+        vorbis_custom_pcm_convert_fmt(get_sample_buffer_offset(outbuf, fmt, channels, samples_done, planar_buf), fmt, pcm, channels, rc);
+        samples_done += rc;
+    } while (samples_done < samples_to_do);
+}
+
+/* Decodes from the current position until the end (or max_samples) straight to a sink, a whole
+ * libvorbis block at a time. Returns samples done (less than expected on errors or if the sink stops). */
+int32_t decode_ogg_vorbis_to_end(ogg_vorbis_codec_data * data, sample_fmt_t fmt, int channels, int32_t max_samples, vgmstream_sink_t sink, void * user_data) {
+    int32_t samples_done = 0;
+    uint8_t * buf = NULL;
+    OggVorbis_File *ogg_vorbis_file = &data->ogg_vorbis_file;
+
+    /* converted samples for the sink (float planar is passed as-is) */
+    if (fmt != SAMPLE_FMT_FLOATP) {
+        buf = malloc(OGG_SINK_BUFFER_SAMPLES * channels * sizeof(int32_t));
+        if (!buf) return 0;
+    }
+
+    while (samples_done < max_samples) {
+        float **pcm;
+        long rc = ov_read_float(ogg_vorbis_file, &pcm, max_samples - samples_done, &data->bitstream);
+
+        if (rc <= 0) break;
+
+        samples_done += rc;
+        if (!vorbis_custom_pcm_sink(pcm, channels, rc, fmt, buf, OGG_SINK_BUFFER_SAMPLES, sink, user_data))
+            break;
+    }
+
+    free(buf);
+    return samples_done;
+}
 
 void reset_ogg_vorbis(VGMSTREAM *vgmstream) {
     OggVorbis_File *ogg_vorbis_file;
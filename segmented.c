@@ -5,8 +5,9 @@
 /* Decodes samples for segmented streams.
  * Chains together sequential vgmstreams, for data divided into separate sections or files
  * (like one part for intro and other for loop segments, which may even use different codecs). */
-void render_vgmstream_segmented(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream) {
+void render_vgmstream_segmented(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
     int samples_written = 0;
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
     segmented_layout_data *data = vgmstream->layout_data;
 
 
@@ -54,8 +55,8 @@ void render_vgmstream_segmented(sample * buffer, int32_t sample_count, VGMSTREAM
             continue;
         }
 
-        render_vgmstream(&buffer[samples_written*data->segments[data->current_segment]->channels],
-                samples_to_do,data->segments[data->current_segment]);
+        render_vgmstream_fmt(get_sample_buffer_offset(buffer, fmt, vgmstream->channels, samples_written, planar_buf),
+                fmt, samples_to_do,data->segments[data->current_segment]);
 
         samples_written += samples_to_do;
         vgmstream->current_sample += samples_to_do;
@@ -1,95 +1,586 @@
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef VGM_USE_IO_URING
+#include <liburing.h>
+#endif
+#endif
 #include "streamfile.h"
 #include "util.h"
 #include "vgmstream.h"
 
 
+/* Process-wide cache of aligned file blocks shared by all stdio STREAMFILEs, since the same file is
+ * typically opened many times (meta parsing, per-channel reopens, subsongs, multiple voices) and would
+ * re-read the same bytes into separate buffers. Blocks are keyed by file identity (device+inode, plus
+ * size+mtime so changed files don't return stale data) and evicted in LRU order once the max is reached. */
+#define STDIO_CACHE_BLOCK_SIZE  0x8000
+#define STDIO_CACHE_MAX_BLOCKS  512     /* 16MB */
+#define STDIO_CACHE_HASH_SIZE   1024
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    uint64_t mtime;     /* in nanoseconds where available (files may be rewritten within a second) */
+} stdio_cache_key;
+
+typedef struct stdio_cache_block {
+    stdio_cache_key key;
+    uint64_t index;                     /* block number in file */
+    size_t size;                        /* valid data (may be smaller at EOF) */
+    struct stdio_cache_block * prev;    /* LRU list, most recent first */
+    struct stdio_cache_block * next;
+    struct stdio_cache_block * hash_next;
+    uint8_t data[STDIO_CACHE_BLOCK_SIZE];
+} stdio_cache_block;
+
+static stdio_cache_block * cache_hash[STDIO_CACHE_HASH_SIZE];
+static stdio_cache_block * cache_head = NULL;
+static stdio_cache_block * cache_tail = NULL;
+static int cache_count = 0;
+static vgm_mutex_t cache_mutex = VGM_MUTEX_INIT;
+
+/* FILE shared by STREAMFILEs reopened on the same name (reads are positional on POSIX, so handles
+ * and threads don't fight over the FILE position and no extra fds are needed) */
+typedef struct {
+    FILE * infile;
+    int refs;               /* STREAMFILEs using it, closed when 0 */
+} stdio_file;
+
+static vgm_mutex_t stdio_file_mutex = VGM_MUTEX_INIT;
+
+static void retain_stdio_file(stdio_file * file) {
+    vgm_mutex_lock(&stdio_file_mutex);
+    file->refs++;
+    vgm_mutex_unlock(&stdio_file_mutex);
+}
+
+static void release_stdio_file(stdio_file * file) {
+    int refs;
+
+    vgm_mutex_lock(&stdio_file_mutex);
+    refs = --file->refs;
+    vgm_mutex_unlock(&stdio_file_mutex);
+    if (refs == 0) {
+        fclose(file->infile);
+        free(file);
+    }
+}
+
 /* a STREAMFILE that operates via standard IO using a buffer */
 typedef struct {
     STREAMFILE sf;          /* callbacks */
 
-    FILE * infile;          /* actual FILE */
+    stdio_file * file;      /* actual FILE */
     char name[PATH_LIMIT];  /* FILE filename */
     off_t offset;           /* last read offset (info) */
     off_t buffer_offset;    /* current buffer data start */
     uint8_t * buffer;       /* data buffer */
-    size_t buffersize;      /* max buffer size */
+    size_t buffersize;      /* max buffer size (of each buffer) */
     size_t validsize;       /* current buffer size */
     size_t filesize;        /* buffered file size */
+
+    /* previous buffer, kept when refilling so reads around the buffer edge (or jumping back a bit) don't re-read */
+    off_t back_offset;
+    uint8_t * back_buffer;
+    size_t back_validsize;
+    int sequential;         /* refills follow each other, so the OS is asked to read ahead */
+
+    int cached;             /* file can use the block cache */
+    stdio_cache_key cache_key;
 } STDIOSTREAMFILE;
 
 static STREAMFILE * open_stdio_streamfile_buffer(const char * const filename, size_t buffersize);
 static STREAMFILE * open_stdio_streamfile_buffer_by_file(FILE *infile,const char * const filename, size_t buffersize);
+static STREAMFILE * open_stdio_streamfile_buffer_shared(stdio_file * file,const char * const filename, size_t buffersize);
 
-static size_t read_stdio(STDIOSTREAMFILE *streamfile,uint8_t * dest, off_t offset, size_t length) {
-    size_t length_read_total = 0;
+static unsigned int cache_hash_index(const stdio_cache_key * key, uint64_t index) {
+    uint64_t hash = VGM_HASH_INIT;
+    hash = hash_fnv1a(hash, (const uint8_t *)key, sizeof(stdio_cache_key));
+    hash = hash_fnv1a(hash, (const uint8_t *)&index, sizeof(index));
+    return (unsigned int)(hash % STDIO_CACHE_HASH_SIZE);
+}
 
-    if (!streamfile || !dest || length <= 0 || offset < 0)
-        return 0;
+static void cache_unlink(stdio_cache_block * block) {
+    if (block->prev) block->prev->next = block->next;
+    else cache_head = block->next;
+    if (block->next) block->next->prev = block->prev;
+    else cache_tail = block->prev;
+}
 
-    /* is the part of the requested length in the buffer? */
-    if (offset >= streamfile->buffer_offset && offset < streamfile->buffer_offset + streamfile->validsize) {
-        size_t length_to_read;
-        off_t offset_into_buffer = offset - streamfile->buffer_offset;
+static void cache_link_head(stdio_cache_block * block) {
+    block->prev = NULL;
+    block->next = cache_head;
+    if (cache_head) cache_head->prev = block;
+    cache_head = block;
+    if (!cache_tail) cache_tail = block;
+}
 
-        length_to_read = streamfile->validsize - offset_into_buffer;
-        if (length_to_read > length)
-            length_to_read = length;
+static stdio_cache_block * cache_find(const stdio_cache_key * key, uint64_t index) {
+    stdio_cache_block * block = cache_hash[cache_hash_index(key, index)];
+    while (block) {
+        if (block->index == index && memcmp(&block->key, key, sizeof(stdio_cache_key)) == 0)
+            return block;
+        block = block->hash_next;
+    }
+    return NULL;
+}
 
-        memcpy(dest,streamfile->buffer + offset_into_buffer,length_to_read);
-        length_read_total += length_to_read;
-        length -= length_to_read;
-        offset += length_to_read;
-        dest += length_to_read;
+static void cache_remove(stdio_cache_block * block) {
+    stdio_cache_block ** link = &cache_hash[cache_hash_index(&block->key, block->index)];
+    while (*link != block)
+        link = &(*link)->hash_next;
+    *link = block->hash_next;
+    cache_unlink(block);
+    cache_count--;
+}
+
+/* copies up to length bytes from skip into a cached block, returns -1 if not cached */
+static int cache_get(const stdio_cache_key * key, uint64_t index, size_t skip, uint8_t * dest, size_t length) {
+    stdio_cache_block * block;
+    int copied = -1;
+
+    vgm_mutex_lock(&cache_mutex);
+    block = cache_find(key, index);
+    if (block) {
+        if (block != cache_head) { /* most recently used */
+            cache_unlink(block);
+            cache_link_head(block);
+        }
+
+        copied = skip < block->size ? block->size - skip : 0;
+        if (copied > length)
+            copied = length;
+        memcpy(dest, block->data + skip, copied);
     }
+    vgm_mutex_unlock(&cache_mutex);
 
+    return copied;
+}
 
-    /* read the rest of the requested length */
-    while (length > 0) {
-        size_t length_to_read;
+/* adds a block, taking ownership of it (freed if another thread added it meanwhile) */
+static void cache_put(stdio_cache_block * block) {
+    stdio_cache_block * evicted = NULL;
+    unsigned int hash_index = cache_hash_index(&block->key, block->index);
 
-        /* ignore requests at EOF */
-        if (offset >= streamfile->filesize) {
-            //offset = streamfile->filesize; /* seems fseek doesn't clamp offset */
-            VGM_ASSERT_ONCE(offset > streamfile->filesize, "STDIO: reading over filesize 0x%x @ 0x%"PRIx64" + 0x%x\n", streamfile->filesize, (off64_t)offset, length);
+    vgm_mutex_lock(&cache_mutex);
+    if (cache_find(&block->key, block->index)) {
+        vgm_mutex_unlock(&cache_mutex);
+        free(block);
+        return;
+    }
+
+    if (cache_count >= STDIO_CACHE_MAX_BLOCKS) {
+        evicted = cache_tail;
+        cache_remove(evicted);
+    }
+
+    block->hash_next = cache_hash[hash_index];
+    cache_hash[hash_index] = block;
+    cache_link_head(block);
+    cache_count++;
+    vgm_mutex_unlock(&cache_mutex);
+
+    free(evicted);
+}
+
+#ifndef _WIN32
+/* positional read (no seek, and safe with a shared fd), returns bytes read */
+static size_t pread_full(int fd, uint8_t * dest, off_t offset, size_t length) {
+    size_t done = 0;
+
+    while (done < length) {
+        ssize_t bytes = pread(fd, dest + done, length - done, offset + done);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
             break;
-        }
+        done += bytes;
+    }
 
-        /* position to new offset */
-        if (fseeko(streamfile->infile,offset,SEEK_SET)) {
-            break; /* this shouldn't happen in our code */
-        }
+    return done;
+}
+#endif
+
+/* reads from the file directly, returns bytes read */
+static size_t read_file_stdio(STDIOSTREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
+#ifndef _WIN32
+    return pread_full(fileno(streamfile->file->infile), dest, offset, length);
+#else
+    /* position to new offset */
+    if (fseeko(streamfile->file->infile,offset,SEEK_SET)) {
+        return 0; /* this shouldn't happen in our code */
+    }
 
 #ifdef _MSC_VER
-        /* Workaround a bug that appears when compiling with MSVC (later versions).
-         * This bug is deterministic and seemingly appears randomly after seeking.
-         * It results in fread returning data from the wrong area of the file.
-         * HPS is one format that is almost always affected by this. */
-        fseek(streamfile->infile, ftell(streamfile->infile), SEEK_SET);
+    /* Workaround a bug that appears when compiling with MSVC (later versions).
+     * This bug is deterministic and seemingly appears randomly after seeking.
+     * It results in fread returning data from the wrong area of the file.
+     * HPS is one format that is almost always affected by this. */
+    fseek(streamfile->file->infile, ftell(streamfile->file->infile), SEEK_SET);
 #endif
 
-        /* fill the buffer (offset now is beyond buffer_offset) */
-        streamfile->buffer_offset = offset;
-        streamfile->validsize = fread(streamfile->buffer,sizeof(uint8_t),streamfile->buffersize,streamfile->infile);
+    return fread(dest,sizeof(uint8_t),length,streamfile->file->infile);
+#endif
+}
 
-        /* decide how much must be read this time */
-        if (length > streamfile->buffersize)
-            length_to_read = streamfile->buffersize;
-        else
-            length_to_read = length;
+/* reads through the block cache, loading missing blocks from the file */
+static size_t read_cache_stdio(STDIOSTREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
+    size_t done = 0;
 
-        /* give up on partial reads (EOF) */
-        if (streamfile->validsize < length_to_read) {
-            memcpy(dest,streamfile->buffer,streamfile->validsize);
-            offset += streamfile->validsize;
-            length_read_total += streamfile->validsize;
+    while (done < length && offset + done < streamfile->filesize) {
+        uint64_t index = (offset + done) / STDIO_CACHE_BLOCK_SIZE;
+        size_t skip = (offset + done) % STDIO_CACHE_BLOCK_SIZE;
+        int copied;
+
+        copied = cache_get(&streamfile->cache_key, index, skip, dest + done, length - done);
+        if (copied < 0) {
+            stdio_cache_block * block = malloc(sizeof(stdio_cache_block));
+            if (!block) /* read the rest as-is */
+                return done + read_file_stdio(streamfile, dest + done, offset + done, length - done);
+
+            block->key = streamfile->cache_key;
+            block->index = index;
+            block->size = read_file_stdio(streamfile, block->data, index * STDIO_CACHE_BLOCK_SIZE, STDIO_CACHE_BLOCK_SIZE);
+
+            copied = skip < block->size ? block->size - skip : 0;
+            if (copied > length - done)
+                copied = length - done;
+            memcpy(dest + done, block->data + skip, copied);
+
+            /* short reads (I/O errors, file changed) aren't cached, or the next reads would see a bogus EOF */
+            if (block->size == STDIO_CACHE_BLOCK_SIZE || index * STDIO_CACHE_BLOCK_SIZE + block->size == (uint64_t)streamfile->filesize)
+                cache_put(block);
+            else
+                free(block);
+        }
+
+        if (copied == 0)
+            break;
+        done += copied;
+    }
+
+    return done;
+}
+
+#if defined(VGM_USE_IO_URING) && !defined(_WIN32)
+/* Async prefetch: sequential refills queue reads of the next blocks, and completions add them to the block
+ * cache, so by the time the decoder needs them the refill is a memory copy. Requests from all streams are
+ * batched into one io_uring submit per refill, and completions are reaped by a helper thread. If the kernel
+ * doesn't allow io_uring (old or sandboxed) a small thread pool does blocking preads instead. */
+#define STDIO_PREFETCH_BLOCKS   4       /* ahead of a sequential refill */
+#define STDIO_PREFETCH_MAX      64      /* requests in flight */
+#define STDIO_PREFETCH_THREADS  2       /* pool fallback */
+
+typedef struct stdio_prefetch_req {
+    stdio_file * file;                  /* retained until done */
+    stdio_cache_block * block;          /* key/index set, filled by the read */
+    size_t expected;                    /* full block, or less at EOF */
+    struct stdio_prefetch_req * next;   /* in flight list */
+    struct stdio_prefetch_req * queue_next; /* pool queue */
+} stdio_prefetch_req;
+
+enum { PREFETCH_NONE, PREFETCH_URING, PREFETCH_POOL };
+static int prefetch_mode = PREFETCH_NONE;
+static pthread_once_t prefetch_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t prefetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_cond = PTHREAD_COND_INITIALIZER;
+static struct io_uring prefetch_ring;
+static stdio_prefetch_req * prefetch_inflight = NULL;
+static int prefetch_count = 0;
+static stdio_prefetch_req * prefetch_queue = NULL;
+
+/* call with prefetch_mutex held */
+static void prefetch_unlink(stdio_prefetch_req * req) {
+    stdio_prefetch_req ** link;
+
+    for (link = &prefetch_inflight; *link != req; link = &(*link)->next)
+        ;
+    *link = req->next;
+    prefetch_count--;
+}
+
+static void prefetch_done(stdio_prefetch_req * req, size_t bytes) {
+    pthread_mutex_lock(&prefetch_mutex);
+    prefetch_unlink(req);
+    pthread_mutex_unlock(&prefetch_mutex);
+
+    /* short reads are ignored, the decoder will read the block itself */
+    req->block->size = bytes;
+    if (bytes == req->expected)
+        cache_put(req->block);
+    else
+        free(req->block);
+
+    release_stdio_file(req->file);
+    free(req);
+}
+
+static void * prefetch_uring_thread(void * arg) {
+    while (1) {
+        struct io_uring_cqe * cqe;
+        stdio_prefetch_req * req;
+        int res;
+
+        res = io_uring_wait_cqe(&prefetch_ring, &cqe);
+        if (res == -EINTR)
+            continue;
+        if (res < 0) { /* broken ring, stop prefetching (requests in flight are left as-is, as the kernel may own them) */
+            VGM_LOG("STREAMFILE: io_uring wait error %i\n", res);
+            pthread_mutex_lock(&prefetch_mutex);
+            prefetch_mode = PREFETCH_NONE;
+            pthread_mutex_unlock(&prefetch_mutex);
             break;
         }
+        req = io_uring_cqe_get_data(cqe);
+        res = cqe->res;
+        io_uring_cqe_seen(&prefetch_ring, cqe);
 
-        /* use the new buffer */
-        memcpy(dest,streamfile->buffer,length_to_read);
+        prefetch_done(req, res > 0 ? res : 0);
+    }
+    return NULL;
+}
+
+static void * prefetch_pool_thread(void * arg) {
+    while (1) {
+        stdio_prefetch_req * req;
+        size_t bytes;
+
+        pthread_mutex_lock(&prefetch_mutex);
+        while (!prefetch_queue)
+            pthread_cond_wait(&prefetch_cond, &prefetch_mutex);
+        req = prefetch_queue;
+        prefetch_queue = req->queue_next;
+        pthread_mutex_unlock(&prefetch_mutex);
+
+        bytes = pread_full(fileno(req->file->infile), req->block->data, req->block->index * STDIO_CACHE_BLOCK_SIZE, req->expected);
+        prefetch_done(req, bytes);
+    }
+    return NULL;
+}
+
+static void prefetch_start_pool(void) {
+    pthread_t thread;
+    int i;
+
+    for (i = 0; i < STDIO_PREFETCH_THREADS; i++) {
+        if (pthread_create(&thread, NULL, prefetch_pool_thread, NULL) != 0)
+            break;
+        pthread_detach(thread);
+        prefetch_mode = PREFETCH_POOL;
+    }
+}
+
+static void prefetch_init(void) {
+    pthread_t thread;
+
+    if (io_uring_queue_init(STDIO_PREFETCH_MAX, &prefetch_ring, 0) == 0) {
+        if (pthread_create(&thread, NULL, prefetch_uring_thread, NULL) == 0) {
+            pthread_detach(thread);
+            prefetch_mode = PREFETCH_URING;
+            return;
+        }
+        io_uring_queue_exit(&prefetch_ring);
+    }
+
+    prefetch_start_pool();
+}
+
+/* undoes a request that was never started, call with prefetch_mutex held */
+static void prefetch_cancel(stdio_prefetch_req * req) {
+    prefetch_unlink(req);
+    release_stdio_file(req->file);
+    free(req->block);
+    free(req);
+}
+
+static int prefetch_pending(const stdio_cache_key * key, uint64_t index) {
+    stdio_prefetch_req * req;
+    for (req = prefetch_inflight; req != NULL; req = req->next) {
+        if (req->block->index == index && memcmp(&req->block->key, key, sizeof(stdio_cache_key)) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* queues reads of the blocks after offset that aren't cached or in flight */
+static void prefetch_stdio(STDIOSTREAMFILE *streamfile, off_t offset) {
+    uint64_t index = (offset + STDIO_CACHE_BLOCK_SIZE - 1) / STDIO_CACHE_BLOCK_SIZE;
+    uint64_t last = index + STDIO_PREFETCH_BLOCKS;
+    stdio_prefetch_req * batch[STDIO_PREFETCH_BLOCKS]; /* io_uring reads to submit */
+    int submitted = 0;
+
+    pthread_once(&prefetch_once, prefetch_init);
+
+    pthread_mutex_lock(&prefetch_mutex);
+    if (prefetch_mode == PREFETCH_NONE) {
+        pthread_mutex_unlock(&prefetch_mutex);
+        return;
+    }
+
+    for (; index < last && index * STDIO_CACHE_BLOCK_SIZE < streamfile->filesize; index++) {
+        stdio_prefetch_req * req;
+        int cached;
+
+        if (prefetch_count >= STDIO_PREFETCH_MAX)
+            break;
+
+        vgm_mutex_lock(&cache_mutex);
+        cached = cache_find(&streamfile->cache_key, index) != NULL;
+        vgm_mutex_unlock(&cache_mutex);
+        if (cached || prefetch_pending(&streamfile->cache_key, index))
+            continue;
+
+        req = calloc(1, sizeof(stdio_prefetch_req));
+        if (!req) break;
+        req->block = malloc(sizeof(stdio_cache_block));
+        if (!req->block) {
+            free(req);
+            break;
+        }
+        req->block->key = streamfile->cache_key;
+        req->block->index = index;
+        req->expected = streamfile->filesize - index * STDIO_CACHE_BLOCK_SIZE;
+        if (req->expected > STDIO_CACHE_BLOCK_SIZE)
+            req->expected = STDIO_CACHE_BLOCK_SIZE;
+        req->file = streamfile->file;
+
+        if (prefetch_mode == PREFETCH_URING) {
+            struct io_uring_sqe * sqe = io_uring_get_sqe(&prefetch_ring);
+            if (!sqe) {
+                free(req->block);
+                free(req);
+                break;
+            }
+            io_uring_prep_read(sqe, fileno(req->file->infile), req->block->data, req->expected, index * STDIO_CACHE_BLOCK_SIZE);
+            io_uring_sqe_set_data(sqe, req);
+            batch[submitted] = req;
+            submitted++;
+        }
+        else {
+            stdio_prefetch_req ** link = &prefetch_queue; /* in order */
+            while (*link)
+                link = &(*link)->queue_next;
+            *link = req;
+            pthread_cond_signal(&prefetch_cond);
+        }
+
+        retain_stdio_file(req->file);
+        req->next = prefetch_inflight;
+        prefetch_inflight = req;
+        prefetch_count++;
+    }
+
+    if (submitted) {
+        int ret = io_uring_submit(&prefetch_ring);
+        if (ret < submitted) {
+            int i;
+
+            /* Reads not taken by the kernel stay queued in the ring and a later submit could start them
+             * after they are freed, so stop using the ring and let the pool handle further requests. */
+            VGM_LOG("STREAMFILE: io_uring submit error %i of %i\n", ret, submitted);
+            for (i = (ret > 0 ? ret : 0); i < submitted; i++) {
+                prefetch_cancel(batch[i]);
+            }
+            prefetch_mode = PREFETCH_NONE;
+            prefetch_start_pool();
+        }
+    }
+    pthread_mutex_unlock(&prefetch_mutex);
+}
+#endif
+
+/* Fills the buffer from offset, keeping the old one as back buffer. Returns bytes in the buffer.
+ * When refills are sequential (streaming packets/blocks) the next chunk is hinted to the OS, so it's
+ * read in the background and the next fread doesn't stall on disk. */
+static size_t fill_stdio(STDIOSTREAMFILE *streamfile, off_t offset) {
+    int sequential = (streamfile->validsize && offset == streamfile->buffer_offset + streamfile->validsize);
+
+    /* swap buffers */
+    {
+        uint8_t * buffer = streamfile->back_buffer;
+        streamfile->back_buffer = streamfile->buffer;
+        streamfile->back_offset = streamfile->buffer_offset;
+        streamfile->back_validsize = streamfile->validsize;
+        streamfile->buffer = buffer;
+        streamfile->validsize = 0;
+    }
+
+    streamfile->buffer_offset = offset;
+    if (streamfile->cached)
+        streamfile->validsize = read_cache_stdio(streamfile, streamfile->buffer, offset, streamfile->buffersize);
+    else
+        streamfile->validsize = read_file_stdio(streamfile, streamfile->buffer, offset, streamfile->buffersize);
+
+#if defined(VGM_USE_IO_URING) && !defined(_WIN32)
+    if (sequential && streamfile->cached)
+        prefetch_stdio(streamfile, offset + streamfile->validsize);
+#endif
+#if defined(POSIX_FADV_WILLNEED)
+    if (sequential) {
+        off_t next_offset = offset + streamfile->validsize;
+
+        if (!streamfile->sequential) /* larger OS read-ahead window from now on */
+            posix_fadvise(fileno(streamfile->file->infile), 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (next_offset < streamfile->filesize)
+            posix_fadvise(fileno(streamfile->file->infile), next_offset, streamfile->buffersize * 2, POSIX_FADV_WILLNEED);
+    }
+#endif
+    streamfile->sequential = sequential;
+
+    return streamfile->validsize;
+}
+
+/* finds offset in either buffer, returning the available bytes from it (0 if not buffered) */
+static size_t find_stdio(STDIOSTREAMFILE *streamfile, off_t offset, const uint8_t ** ptr) {
+    if (offset >= streamfile->buffer_offset && offset < streamfile->buffer_offset + streamfile->validsize) {
+        *ptr = streamfile->buffer + (offset - streamfile->buffer_offset);
+        return streamfile->validsize - (offset - streamfile->buffer_offset);
+    }
+    if (offset >= streamfile->back_offset && offset < streamfile->back_offset + streamfile->back_validsize) {
+        *ptr = streamfile->back_buffer + (offset - streamfile->back_offset);
+        return streamfile->back_validsize - (offset - streamfile->back_offset);
+    }
+    return 0;
+}
+
+static size_t read_stdio(STDIOSTREAMFILE *streamfile,uint8_t * dest, off_t offset, size_t length) {
+    size_t length_read_total = 0;
+
+    if (!streamfile || !dest || length <= 0 || offset < 0)
+        return 0;
+
+    while (length > 0) {
+        const uint8_t * buf;
+        size_t length_to_read;
+
+        /* is the part of the requested length in the buffers? */
+        length_to_read = find_stdio(streamfile, offset, &buf);
+        if (!length_to_read) {
+            /* ignore requests at EOF */
+            if (offset >= streamfile->filesize) {
+                //offset = streamfile->filesize; /* seems fseek doesn't clamp offset */
+                VGM_ASSERT_ONCE(offset > streamfile->filesize, "STDIO: reading over filesize 0x%x @ 0x%"PRIx64" + 0x%x\n", streamfile->filesize, (off64_t)offset, length);
+                break;
+            }
+
+            /* fill the buffer (offset now is beyond both buffers), giving up on failed reads */
+            if (!fill_stdio(streamfile, offset))
+                break;
+            buf = streamfile->buffer;
+            length_to_read = streamfile->validsize;
+        }
+
+        if (length_to_read > length)
+            length_to_read = length;
+
+        memcpy(dest,buf,length_to_read);
         offset += length_to_read;
         length_read_total += length_to_read;
         length -= length_to_read;
@@ -99,6 +590,22 @@ static size_t read_stdio(STDIOSTREAMFILE *streamfile,uint8_t * dest, off_t offse
     streamfile->offset = offset; /* last fread offset */
     return length_read_total;
 }
+static size_t peek_stdio(STDIOSTREAMFILE *streamfile, off_t offset, size_t length, const uint8_t ** ptr) {
+    if (!streamfile || length <= 0 || offset < 0 || length > streamfile->buffersize)
+        return 0;
+
+    /* refill if not fully in either buffer */
+    if (find_stdio(streamfile, offset, ptr) < length) {
+        if (offset + length > streamfile->filesize)
+            return 0;
+        if (fill_stdio(streamfile, offset) < length)
+            return 0;
+        *ptr = streamfile->buffer;
+    }
+
+    streamfile->offset = offset + length;
+    return length;
+}
 static size_t get_size_stdio(STDIOSTREAMFILE * streamfile) {
     return streamfile->filesize;
 }
@@ -110,22 +617,31 @@ static void get_name_stdio(STDIOSTREAMFILE *streamfile,char *buffer,size_t lengt
     buffer[length-1]='\0';
 }
 static void close_stdio(STDIOSTREAMFILE * streamfile) {
-    fclose(streamfile->infile);
+    release_stdio_file(streamfile->file);
     free(streamfile->buffer);
+    free(streamfile->back_buffer);
     free(streamfile);
 }
 
 static STREAMFILE *open_stdio(STDIOSTREAMFILE *streamFile,const char * const filename,size_t buffersize) {
-    int newfd;
-    FILE *newfile;
-    STREAMFILE *newstreamFile;
-
     if (!filename)
         return NULL;
-#if !defined (__ANDROID__)
-    // if same name, duplicate the file pointer we already have open
+#ifndef _WIN32
+    // if same name, share the file we already have open
     if (!strcmp(streamFile->name,filename)) {
-        if (((newfd = dup(fileno(streamFile->infile))) >= 0) &&
+        STREAMFILE *newstreamFile = open_stdio_streamfile_buffer_shared(streamFile->file,filename,buffersize);
+        if (newstreamFile) {
+            return newstreamFile;
+        }
+    }
+#else
+    // if same name, duplicate the file pointer we already have open (reads move the FILE position)
+    if (!strcmp(streamFile->name,filename)) {
+        int newfd;
+        FILE *newfile;
+        STREAMFILE *newstreamFile;
+
+        if (((newfd = dup(fileno(streamFile->file->infile))) >= 0) &&
             (newfile = fdopen( newfd, "rb" ))) 
         {
             newstreamFile = open_stdio_streamfile_buffer_by_file(newfile,filename,buffersize);
@@ -142,45 +658,97 @@ static STREAMFILE *open_stdio(STDIOSTREAMFILE *streamFile,const char * const fil
 }
 
 static STREAMFILE * open_stdio_streamfile_buffer_by_file(FILE *infile,const char * const filename, size_t buffersize) {
+    stdio_file * file;
+    STREAMFILE *streamFile;
+
+    file = calloc(1,sizeof(stdio_file));
+    if (!file) return NULL;
+    file->infile = infile;
+
+    streamFile = open_stdio_streamfile_buffer_shared(file,filename,buffersize);
+    if (!streamFile) {
+        free(file); /* FILE is closed by the caller */
+    }
+
+    return streamFile;
+}
+
+/* opens a new STREAMFILE on file, adding a reference on success */
+static STREAMFILE * open_stdio_streamfile_buffer_shared(stdio_file * file,const char * const filename, size_t buffersize) {
     uint8_t * buffer = NULL;
+    uint8_t * back_buffer = NULL;
     STDIOSTREAMFILE * streamfile = NULL;
 
     buffer = calloc(buffersize,1);
     if (!buffer) goto fail;
+    back_buffer = calloc(buffersize,1);
+    if (!back_buffer) goto fail;
 
     streamfile = calloc(1,sizeof(STDIOSTREAMFILE));
     if (!streamfile) goto fail;
 
     streamfile->sf.read = (void*)read_stdio;
+    streamfile->sf.peek = (void*)peek_stdio;
     streamfile->sf.get_size = (void*)get_size_stdio;
     streamfile->sf.get_offset = (void*)get_offset_stdio;
     streamfile->sf.get_name = (void*)get_name_stdio;
     streamfile->sf.open = (void*)open_stdio;
     streamfile->sf.close = (void*)close_stdio;
 
-    streamfile->infile = infile;
+    streamfile->file = file;
     streamfile->buffersize = buffersize;
     streamfile->buffer = buffer;
+    streamfile->back_buffer = back_buffer;
 
     strncpy(streamfile->name,filename,sizeof(streamfile->name));
     streamfile->name[sizeof(streamfile->name)-1] = '\0';
 
-    /* cache filesize */
-    fseeko(streamfile->infile,0,SEEK_END);
-    streamfile->filesize = ftello(streamfile->infile);
+#ifndef _WIN32
+    /* cache filesize (from the fd, as the FILE position isn't used; 64-bit as long as off_t is) */
+    {
+        struct stat st;
+        if (fstat(fileno(file->infile), &st) != 0) {
+            VGM_LOG("STREAMFILE: fstat error\n");
+            goto fail;
+        }
+        streamfile->filesize = st.st_size;
+
+        if (S_ISREG(st.st_mode)) { /* block cache needs a stable identity */
+            streamfile->cached = 1;
+            streamfile->cache_key.dev = st.st_dev;
+            streamfile->cache_key.ino = st.st_ino;
+            streamfile->cache_key.size = st.st_size;
+#if defined(__APPLE__)
+            streamfile->cache_key.mtime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+            streamfile->cache_key.mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+            streamfile->cache_key.mtime = (uint64_t)st.st_mtime * 1000000000;
+#endif
+        }
+    }
+#else
+    /* cache filesize (Windows has no usable inodes for the block cache) */
+    {
+        off_t filesize;
 
-    /* Typically fseek(o)/ftell(o) may only handle up to ~2.14GB, signed 32b = 0x7FFFFFFF
-     * (happens in banks like FSB, though rarely). Can be remedied with the
-     * preprocessor (-D_FILE_OFFSET_BITS=64 in GCC) but it's not well tested. */
-    if (streamfile->filesize == 0xFFFFFFFF) { /* -1 on error */
-        VGM_LOG("STREAMFILE: ftell error\n");
-        goto fail; /* can be ignored but may result in strange/unexpected behaviors */
+        fseeko(file->infile,0,SEEK_END);
+        filesize = ftello(file->infile);
+        if (filesize < 0) { /* -1 on error */
+            VGM_LOG("STREAMFILE: ftell error\n");
+            goto fail;
+        }
+        streamfile->filesize = filesize;
     }
+#endif
+
+    retain_stdio_file(file);
 
     return &streamfile->sf;
 
 fail:
     free(buffer);
+    free(back_buffer);
     free(streamfile);
     return NULL;
 }
@@ -211,6 +779,165 @@ STREAMFILE * open_stdio_streamfile_by_file(FILE * file, const char * filename) {
 
 /* **************************************************** */
 
+/* a STREAMFILE that maps the whole file read-only, so reads are just copies from memory */
+typedef struct {
+    STREAMFILE sf;
+
+    uint8_t * data;         /* mapped file (NULL if empty) */
+    size_t data_size;       /* file size */
+    off_t offset;           /* last read offset (info) */
+    char name[PATH_LIMIT];
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+} MMAP_STREAMFILE;
+
+static size_t mmap_read(MMAP_STREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
+    if (!streamfile || !dest || length <= 0 || offset < 0)
+        return 0;
+
+    /* ignore requests at EOF */
+    if (offset >= streamfile->data_size) {
+        VGM_ASSERT_ONCE(offset > streamfile->data_size, "MMAP: reading over filesize 0x%x @ 0x%"PRIx64" + 0x%x\n", streamfile->data_size, (off64_t)offset, length);
+        return 0;
+    }
+    if (length > streamfile->data_size - offset)
+        length = streamfile->data_size - offset;
+
+    memcpy(dest, streamfile->data + offset, length);
+
+    streamfile->offset = offset + length;
+    return length;
+}
+static size_t mmap_peek(MMAP_STREAMFILE *streamfile, off_t offset, size_t length, const uint8_t ** ptr) {
+    if (!streamfile || length <= 0 || offset < 0 || offset > streamfile->data_size || length > streamfile->data_size - offset)
+        return 0;
+
+    *ptr = streamfile->data + offset;
+    streamfile->offset = offset + length;
+    return length;
+}
+static size_t mmap_get_size(MMAP_STREAMFILE * streamfile) {
+    return streamfile->data_size;
+}
+static off_t mmap_get_offset(MMAP_STREAMFILE *streamfile) {
+    return streamfile->offset;
+}
+static void mmap_get_name(MMAP_STREAMFILE *streamfile, char *buffer, size_t length) {
+    strncpy(buffer,streamfile->name,length);
+    buffer[length-1]='\0';
+}
+static STREAMFILE *mmap_open(MMAP_STREAMFILE *streamfile, const char * const filename, size_t buffersize) {
+    STREAMFILE *newstreamFile;
+
+    if (!filename)
+        return NULL;
+
+    /* mapping the same file again is cheap (the OS shares pages), and companion files are mapped too */
+    newstreamFile = open_mmap_streamfile(filename);
+    if (newstreamFile)
+        return newstreamFile;
+
+    /* files that can't be mapped (pipes, special files) */
+    return open_stdio_streamfile_buffer(filename,buffersize);
+}
+static void mmap_close(MMAP_STREAMFILE * streamfile) {
+#ifdef _WIN32
+    if (streamfile->data)
+        UnmapViewOfFile(streamfile->data);
+    if (streamfile->mapping)
+        CloseHandle(streamfile->mapping);
+#else
+    if (streamfile->data)
+        munmap(streamfile->data, streamfile->data_size);
+#endif
+    free(streamfile);
+}
+
+STREAMFILE * open_mmap_streamfile(const char * filename) {
+    MMAP_STREAMFILE * streamfile = NULL;
+
+    if (!filename)
+        return NULL;
+
+    streamfile = calloc(1,sizeof(MMAP_STREAMFILE));
+    if (!streamfile) goto fail;
+
+    streamfile->sf.read = (void*)mmap_read;
+    streamfile->sf.peek = (void*)mmap_peek;
+    streamfile->sf.get_size = (void*)mmap_get_size;
+    streamfile->sf.get_offset = (void*)mmap_get_offset;
+    streamfile->sf.get_name = (void*)mmap_get_name;
+    streamfile->sf.open = (void*)mmap_open;
+    streamfile->sf.close = (void*)mmap_close;
+
+    strncpy(streamfile->name,filename,sizeof(streamfile->name));
+    streamfile->name[sizeof(streamfile->name)-1] = '\0';
+
+#ifdef _WIN32
+    {
+        HANDLE file;
+        LARGE_INTEGER size;
+
+        file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) goto fail;
+
+        if (!GetFileSizeEx(file, &size) || (uint64_t)size.QuadPart > (size_t)-1) {
+            CloseHandle(file);
+            goto fail;
+        }
+        streamfile->data_size = (size_t)size.QuadPart;
+
+        if (streamfile->data_size) {
+            /* the mapping keeps the file open */
+            streamfile->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            CloseHandle(file);
+            if (!streamfile->mapping) goto fail;
+
+            streamfile->data = MapViewOfFile(streamfile->mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!streamfile->data) goto fail;
+        }
+        else {
+            CloseHandle(file);
+        }
+    }
+#else
+    {
+        int fd;
+        struct stat st;
+
+        fd = open(filename, O_RDONLY);
+        if (fd < 0) goto fail;
+
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size > (size_t)-1) {
+            close(fd);
+            goto fail;
+        }
+        streamfile->data_size = (size_t)st.st_size;
+
+        if (streamfile->data_size) {
+            void * data = mmap(NULL, streamfile->data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd); /* the mapping keeps the file open */
+            if (data == MAP_FAILED) goto fail;
+
+            streamfile->data = data;
+        }
+        else {
+            close(fd);
+        }
+    }
+#endif
+
+    return &streamfile->sf;
+
+fail:
+    if (streamfile)
+        mmap_close(streamfile);
+    return NULL;
+}
+
+/* **************************************************** */
+
 typedef struct {
     STREAMFILE sf;
 
@@ -287,6 +1014,24 @@ static size_t buffer_read(BUFFER_STREAMFILE *streamfile, uint8_t * dest, off_t o
     streamfile->offset = offset; /* last fread offset */
     return length_read_total;
 }
+static size_t buffer_peek(BUFFER_STREAMFILE *streamfile, off_t offset, size_t length, const uint8_t ** ptr) {
+    if (!streamfile || length <= 0 || offset < 0 || length > streamfile->buffersize)
+        return 0;
+
+    /* refill if not fully in the buffer */
+    if (offset < streamfile->buffer_offset || offset + length > streamfile->buffer_offset + streamfile->validsize) {
+        if (offset + length > streamfile->filesize)
+            return 0;
+        streamfile->buffer_offset = offset;
+        streamfile->validsize = streamfile->inner_sf->read(streamfile->inner_sf, streamfile->buffer, streamfile->buffer_offset, streamfile->buffersize);
+        if (streamfile->validsize < length)
+            return 0;
+    }
+
+    *ptr = streamfile->buffer + (offset - streamfile->buffer_offset);
+    streamfile->offset = offset + length;
+    return length;
+}
 static size_t buffer_get_size(BUFFER_STREAMFILE * streamfile) {
     return streamfile->filesize; /* cache */
 }
@@ -323,6 +1068,7 @@ STREAMFILE *open_buffer_streamfile(STREAMFILE *streamfile, size_t buffer_size) {
 
     /* set callbacks and internals */
     this_sf->sf.read = (void*)buffer_read;
+    this_sf->sf.peek = (void*)buffer_peek;
     this_sf->sf.get_size = (void*)buffer_get_size;
     this_sf->sf.get_offset = (void*)buffer_get_offset;
     this_sf->sf.get_name = (void*)buffer_get_name;
@@ -357,6 +1103,11 @@ typedef struct {
 static size_t wrap_read(WRAP_STREAMFILE *streamfile, uint8_t * dest, off_t offset, size_t length) {
     return streamfile->inner_sf->read(streamfile->inner_sf, dest, offset, length); /* default */
 }
+static size_t wrap_peek(WRAP_STREAMFILE *streamfile, off_t offset, size_t length, const uint8_t ** ptr) {
+    if (!streamfile->inner_sf->peek)
+        return 0;
+    return streamfile->inner_sf->peek(streamfile->inner_sf, offset, length, ptr); /* default */
+}
 static size_t wrap_get_size(WRAP_STREAMFILE * streamfile) {
     return streamfile->inner_sf->get_size(streamfile->inner_sf); /* default */
 }
@@ -384,6 +1135,7 @@ STREAMFILE *open_wrap_streamfile(STREAMFILE *streamfile) {
 
     /* set callbacks and internals */
     this_sf->sf.read = (void*)wrap_read;
+    this_sf->sf.peek = (void*)wrap_peek;
     this_sf->sf.get_size = (void*)wrap_get_size;
     this_sf->sf.get_offset = (void*)wrap_get_offset;
     this_sf->sf.get_name = (void*)wrap_get_name;
@@ -411,6 +1163,11 @@ static size_t clamp_read(CLAMP_STREAMFILE *streamfile, uint8_t *dest, off_t offs
     size_t clamp_length = length > (streamfile->size - offset) ? (streamfile->size - offset) : length;
     return streamfile->inner_sf->read(streamfile->inner_sf, dest, inner_offset, clamp_length);
 }
+static size_t clamp_peek(CLAMP_STREAMFILE *streamfile, off_t offset, size_t length, const uint8_t ** ptr) {
+    if (!streamfile->inner_sf->peek || offset < 0 || offset > streamfile->size || length > streamfile->size - offset)
+        return 0;
+    return streamfile->inner_sf->peek(streamfile->inner_sf, streamfile->start + offset, length, ptr);
+}
 static size_t clamp_get_size(CLAMP_STREAMFILE *streamfile) {
     return streamfile->size;
 }
@@ -450,6 +1207,7 @@ STREAMFILE *open_clamp_streamfile(STREAMFILE *streamfile, off_t start, size_t si
 
     /* set callbacks and internals */
     this_sf->sf.read = (void*)clamp_read;
+    this_sf->sf.peek = (void*)clamp_peek;
     this_sf->sf.get_size = (void*)clamp_get_size;
     this_sf->sf.get_offset = (void*)clamp_get_offset;
     this_sf->sf.get_name = (void*)clamp_get_name;
@@ -1005,6 +1763,61 @@ int find_chunk_be(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset,
 int find_chunk_le(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset, int full_chunk_size, off_t *out_chunk_offset, size_t *out_chunk_size) {
     return find_chunk(streamFile, chunk_id, start_offset, full_chunk_size, out_chunk_offset, out_chunk_size, 0, 0);
 }
+/* Walks all chunks from start_offset to the end of the file in a single pass (same rules as find_chunk),
+ * so multiple lookups don't rescan the header. Returns the number of chunks found. If there are more
+ * than the max the rest are left to find_chunk_directory, which scans them when an id isn't found. */
+int build_chunk_directory(chunk_directory * dir, STREAMFILE *streamFile, off_t start_offset, int size_big_endian) {
+    size_t filesize = get_streamfile_size(streamFile);
+    off_t current_chunk = start_offset;
+
+    dir->count = 0;
+    dir->truncated = 0;
+    dir->next_offset = 0;
+    dir->size_big_endian = size_big_endian;
+    dir->streamFile = streamFile;
+    while (current_chunk < filesize) {
+        uint8_t buf[0x08];
+        chunk_entry * entry;
+
+        if (read_streamfile(buf, current_chunk, sizeof(buf), streamFile) != sizeof(buf))
+            break;
+        if (dir->count >= CHUNK_DIRECTORY_MAX) {
+            VGM_LOG("STREAMFILE: too many chunks at 0x%"PRIx64", rest will be scanned\n", (off64_t)current_chunk);
+            dir->truncated = 1;
+            dir->next_offset = current_chunk;
+            break;
+        }
+
+        entry = &dir->chunks[dir->count];
+        entry->id = (uint32_t)get_32bitBE(buf + 0x00);
+        entry->size = (uint32_t)(size_big_endian ? get_32bitBE(buf + 0x04) : get_32bitLE(buf + 0x04));
+        entry->offset = current_chunk + 0x08;
+        dir->count++;
+
+        current_chunk += 0x08 + entry->size;
+    }
+
+    return dir->count;
+}
+
+/* Finds the first chunk_id in the directory (or after it, if truncated). Returns 0 if not found. */
+int find_chunk_directory(const chunk_directory * dir, uint32_t chunk_id, off_t *out_chunk_offset, size_t *out_chunk_size) {
+    int i;
+
+    for (i = 0; i < dir->count; i++) {
+        if (dir->chunks[i].id == chunk_id) {
+            if (out_chunk_offset) *out_chunk_offset = dir->chunks[i].offset;
+            if (out_chunk_size) *out_chunk_size = dir->chunks[i].size;
+            return 1;
+        }
+    }
+
+    if (dir->truncated)
+        return find_chunk(dir->streamFile, chunk_id, dir->next_offset, 0, out_chunk_offset, out_chunk_size, dir->size_big_endian, 0);
+
+    return 0;
+}
+
 int find_chunk(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset, int full_chunk_size, off_t *out_chunk_offset, size_t *out_chunk_size, int size_big_endian, int zero_size_end) {
     size_t filesize;
     off_t current_chunk = start_offset;
@@ -60,6 +60,9 @@
  * Reads from arbitrary offsets, meaning internally may need fseek equivalents during reads. */
 typedef struct _STREAMFILE {
     size_t (*read)(struct _STREAMFILE *,uint8_t * dest, off_t offset, size_t length);
+    /* optional (may be NULL): sets ptr to length bytes at offset without copying, valid until the next call
+     * to the streamfile. Returns length if all bytes are available, or 0 (then read normally) */
+    size_t (*peek)(struct _STREAMFILE *, off_t offset, size_t length, const uint8_t ** ptr);
     size_t (*get_size)(struct _STREAMFILE *);
     off_t (*get_offset)(struct _STREAMFILE *);    
     /* for dual-file support */
@@ -81,6 +84,11 @@ STREAMFILE *open_stdio_streamfile(const char * filename);
 /* Opens a standard STREAMFILE from a pre-opened FILE. */
 STREAMFILE *open_stdio_streamfile_by_file(FILE * file, const char * filename);
 
+/* Opens a STREAMFILE that maps the whole file in memory (read-only), opening from path.
+ * Reads are plain memory copies, so it's faster for many small reads, but not all files can be
+ * mapped (returns NULL) and big files need a big enough address space. */
+STREAMFILE *open_mmap_streamfile(const char * filename);
+
 /* Opens a STREAMFILE that does buffered IO.
  * Can be used when the underlying IO may be slow (like when using custom IO).
  * Buffer size is optional. */
@@ -135,6 +143,19 @@ static inline size_t read_streamfile(uint8_t * dest, off_t offset, size_t length
     return streamfile->read(streamfile,dest,offset,length);
 }
 
+/* Gets a pointer to length bytes at offset, valid until the next call to the streamfile.
+ * Data isn't copied if the streamfile supports it, otherwise it's read into buf (at least length bytes).
+ * Returns NULL if not all bytes could be read. */
+static inline const uint8_t * peek_streamfile(uint8_t * buf, off_t offset, size_t length, STREAMFILE * streamfile) {
+    const uint8_t * ptr;
+
+    if (streamfile->peek && streamfile->peek(streamfile, offset, length, &ptr) == length)
+        return ptr;
+    if (read_streamfile(buf, offset, length, streamfile) != length)
+        return NULL;
+    return buf;
+}
+
 /* return file size */
 static inline size_t get_streamfile_size(STREAMFILE * streamfile) {
     return streamfile->get_size(streamfile);
@@ -212,6 +233,28 @@ int find_chunk_be(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset,
 int find_chunk_le(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset, int full_chunk_size, off_t *out_chunk_offset, size_t *out_chunk_size);
 int find_chunk(STREAMFILE *streamFile, uint32_t chunk_id, off_t start_offset, int full_chunk_size, off_t *out_chunk_offset, size_t *out_chunk_size, int size_big_endian, int zero_size_end);
 
+/* RIFF-style chunk list (32b BE id + 32b size + data), read once for metas that need multiple chunks */
+#define CHUNK_DIRECTORY_MAX 64 /* arbitrary max, more than enough for usual headers */
+typedef struct {
+    uint32_t id;
+    off_t offset;       /* chunk data (after id+size) */
+    size_t size;
+} chunk_entry;
+
+typedef struct {
+    chunk_entry chunks[CHUNK_DIRECTORY_MAX];
+    int count;
+
+    /* when there are more chunks than the max, lookups of missing ids continue with find_chunk */
+    int truncated;
+    off_t next_offset;
+    int size_big_endian;
+    STREAMFILE *streamFile; /* not owned, must outlive the directory */
+} chunk_directory;
+
+int build_chunk_directory(chunk_directory * dir, STREAMFILE *streamFile, off_t start_offset, int size_big_endian);
+int find_chunk_directory(const chunk_directory * dir, uint32_t chunk_id, off_t *out_chunk_offset, size_t *out_chunk_size);
+
 void get_streamfile_name(STREAMFILE *streamFile, char * buffer, size_t size);
 void get_streamfile_filename(STREAMFILE *streamFile, char * buffer, size_t size);
 void get_streamfile_basename(STREAMFILE *streamFile, char * buffer, size_t size);
@@ -28,4 +28,16 @@
 
 typedef int16_t sample;
 
+/* output sample formats (codecs that decode to float may output non-16-bit formats directly) */
+typedef enum {
+    SAMPLE_FMT_S16,         /* sample (default) */
+    SAMPLE_FMT_S32,         /* int32_t, full range */
+    SAMPLE_FMT_FLOAT,       /* float, -1.0 to 1.0 (not clamped) */
+
+    /* planar variants: buffer is a void** with one buffer per channel */
+    SAMPLE_FMT_S16P,
+    SAMPLE_FMT_S32P,
+    SAMPLE_FMT_FLOATP,
+} sample_fmt_t;
+
 #endif
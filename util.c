@@ -107,6 +107,88 @@ void swap_samples_le(sample *buf, int count) {
     }
 }
 
+void convert_samples_s16(void * dst, sample_fmt_t fmt, const sample * src, int count) {
+    int i;
+
+    switch(fmt) {
+        case SAMPLE_FMT_S32: {
+            int32_t * dst32 = dst;
+            for (i = 0; i < count; i++) {
+                dst32[i] = (int32_t)src[i] * 65536;
+            }
+            break;
+        }
+        case SAMPLE_FMT_FLOAT: {
+            float * dstf = dst;
+            for (i = 0; i < count; i++) {
+                dstf[i] = src[i] / 32768.0f;
+            }
+            break;
+        }
+        default:
+            if (dst != src)
+                memmove(dst, src, count * sizeof(sample));
+            break;
+    }
+}
+
+void deinterleave_samples_s16(void ** dst, sample_fmt_t fmt, const sample * src, int channels, int count) {
+    int i, ch;
+
+    for (ch = 0; ch < channels; ch++) {
+        switch(fmt) {
+            case SAMPLE_FMT_S32P: {
+                int32_t * dst32 = dst[ch];
+                for (i = 0; i < count; i++) {
+                    dst32[i] = (int32_t)src[i*channels + ch] * 65536;
+                }
+                break;
+            }
+            case SAMPLE_FMT_FLOATP: {
+                float * dstf = dst[ch];
+                for (i = 0; i < count; i++) {
+                    dstf[i] = src[i*channels + ch] / 32768.0f;
+                }
+                break;
+            }
+            default: {
+                sample * dst16 = dst[ch];
+                for (i = 0; i < count; i++) {
+                    dst16[i] = src[i*channels + ch];
+                }
+                break;
+            }
+        }
+    }
+}
+
+void * get_sample_buffer_offset(void * buffer, sample_fmt_t fmt, int channels, int offset, void ** planar_buf) {
+    size_t sample_size = get_sample_fmt_size(fmt);
+    int ch;
+
+    if (!is_sample_fmt_planar(fmt))
+        return (uint8_t*)buffer + offset * channels * sample_size;
+
+    for (ch = 0; ch < channels; ch++) {
+        planar_buf[ch] = (uint8_t*)((void**)buffer)[ch] + offset * sample_size;
+    }
+    return planar_buf;
+}
+
+void clear_sample_buffer(void * buffer, sample_fmt_t fmt, int channels, int offset, int count) {
+    size_t sample_size = get_sample_fmt_size(fmt);
+    int ch;
+
+    if (!is_sample_fmt_planar(fmt)) {
+        memset((uint8_t*)buffer + offset * channels * sample_size, 0, count * channels * sample_size);
+        return;
+    }
+
+    for (ch = 0; ch < channels; ch++) {
+        memset((uint8_t*)((void**)buffer)[ch] + offset * sample_size, 0, count * sample_size);
+    }
+}
+
 /* length is maximum length of dst. dst will always be null-terminated if
  * length > 0 */
 void concatn(int length, char * dst, const char * src) {
@@ -73,8 +73,78 @@ const char * filename_extension(const char * filename);
 
 void swap_samples_le(sample *buf, int count);
 
+static inline size_t get_sample_fmt_size(sample_fmt_t fmt) {
+    switch(fmt) {
+        case SAMPLE_FMT_S32:
+        case SAMPLE_FMT_S32P:   return sizeof(int32_t);
+        case SAMPLE_FMT_FLOAT:
+        case SAMPLE_FMT_FLOATP: return sizeof(float);
+        default:                return sizeof(sample);
+    }
+}
+
+static inline int is_sample_fmt_planar(sample_fmt_t fmt) {
+    return fmt == SAMPLE_FMT_S16P || fmt == SAMPLE_FMT_S32P || fmt == SAMPLE_FMT_FLOATP;
+}
+
+static inline sample_fmt_t get_sample_fmt_packed(sample_fmt_t fmt) {
+    switch(fmt) {
+        case SAMPLE_FMT_S16P:   return SAMPLE_FMT_S16;
+        case SAMPLE_FMT_S32P:   return SAMPLE_FMT_S32;
+        case SAMPLE_FMT_FLOATP: return SAMPLE_FMT_FLOAT;
+        default:                return fmt;
+    }
+}
+
+static inline sample_fmt_t get_sample_fmt_planar(sample_fmt_t fmt) {
+    switch(fmt) {
+        case SAMPLE_FMT_S16:    return SAMPLE_FMT_S16P;
+        case SAMPLE_FMT_S32:    return SAMPLE_FMT_S32P;
+        case SAMPLE_FMT_FLOAT:  return SAMPLE_FMT_FLOATP;
+        default:                return fmt;
+    }
+}
+
+/* converts 16-bit PCM samples to another (non-planar) sample format (dst and src may be the same buffer for S16) */
+void convert_samples_s16(void * dst, sample_fmt_t fmt, const sample * src, int count);
+/* converts interleaved 16-bit PCM samples to a planar sample format */
+void deinterleave_samples_s16(void ** dst, sample_fmt_t fmt, const sample * src, int channels, int count);
+
+/* Returns a buffer that starts offset samples into buffer. For planar formats the moved
+ * channel pointers are written to planar_buf (at least channels big), which is returned. */
+void * get_sample_buffer_offset(void * buffer, sample_fmt_t fmt, int channels, int offset, void ** planar_buf);
+/* sets count samples to 0, starting offset samples into buffer */
+void clear_sample_buffer(void * buffer, sample_fmt_t fmt, int channels, int offset, int count);
+
 void concatn(int length, char * dst, const char * src);
 
+/* FNV-1a 64b hash, for cache keys (start with hash = VGM_HASH_INIT, can be chained) */
+#define VGM_HASH_INIT 0xcbf29ce484222325ULL
+static inline uint64_t hash_fnv1a(uint64_t hash, const uint8_t * buf, size_t size) {
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= buf[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/* Minimal process-wide lock for shared caches, statically initialized with VGM_MUTEX_INIT */
+#ifdef _WIN32
+#include <windows.h>
+typedef SRWLOCK vgm_mutex_t;
+#define VGM_MUTEX_INIT SRWLOCK_INIT
+#define vgm_mutex_lock(mutex) AcquireSRWLockExclusive(mutex)
+#define vgm_mutex_unlock(mutex) ReleaseSRWLockExclusive(mutex)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t vgm_mutex_t;
+#define VGM_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define vgm_mutex_lock(mutex) pthread_mutex_lock(mutex)
+#define vgm_mutex_unlock(mutex) pthread_mutex_unlock(mutex)
+#endif
+
 
 /* Simple stdout logging for debugging and regression testing purposes.
  * Needs C99 variadic macros, uses do..while to force ";" as statement */
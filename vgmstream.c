@@ -7,6 +7,7 @@
 #include "coding.h"
 
 static void try_dual_file_stereo(VGMSTREAM * opened_vgmstream, STREAMFILE *streamFile, VGMSTREAM* (*init_vgmstream_function)(STREAMFILE*));
+static int is_meta_plausible(VGMSTREAM* (*init_vgmstream_function)(STREAMFILE*), const uint8_t * header);
 
 
 /* List of functions that will recognize files */
@@ -17,19 +18,44 @@ VGMSTREAM * (*init_vgmstream_functions[])(STREAMFILE *streamFile) = {
     init_vgmstream_wwise,
 };
 
+/* Metas that only accept files starting with a fixed id (in any of their variants), so they can be skipped
+ * without probing when none matches. Metas not listed (ids vary, extension-only or encrypted) are always tried. */
+typedef struct {
+    VGMSTREAM * (*init)(STREAMFILE *);
+    uint32_t id_00;     /* 32b BE at 0x00 */
+    uint32_t id_08;     /* 32b BE at 0x08 (0 = any) */
+} meta_signature;
+
+static const meta_signature meta_signatures[] = {
+    {init_vgmstream_wwise,      0x52494646, 0x57415645}, /* "RIFF" "WAVE" */
+    {init_vgmstream_wwise,      0x52494646, 0x58574D41}, /* "RIFF" "XWMA" */
+    {init_vgmstream_wwise,      0x52494658, 0x57415645}, /* "RIFX" "WAVE" */
+    {init_vgmstream_wwise,      0x52494658, 0x58574D41}, /* "RIFX" "XWMA" */
+};
+
 
 /* internal version with all parameters */
 static VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile) {
     int i, fcns_size;
+    uint8_t header[0x10] = {0};
     
     if (!streamFile)
         return NULL;
 
+    /* read the ids once (files smaller than this leave zeroes, which match nothing) */
+    read_streamfile(header, 0x00, sizeof(header), streamFile);
+
     fcns_size = (sizeof(init_vgmstream_functions)/sizeof(init_vgmstream_functions[0]));
     /* try a series of formats, see which works */
     for (i=0; i < fcns_size; i++) {
+        VGMSTREAM * vgmstream;
+
+        /* skip metas whose ids can't match (same order as a full scan, so same results) */
+        if (!is_meta_plausible(init_vgmstream_functions[i], header))
+            continue;
+
         /* call init function and see if valid VGMSTREAM was returned */
-        VGMSTREAM * vgmstream = (init_vgmstream_functions[i])(streamFile);
+        vgmstream = (init_vgmstream_functions[i])(streamFile);
         if (!vgmstream)
             continue;
 
@@ -86,6 +112,25 @@ static VGMSTREAM * init_vgmstream_internal(STREAMFILE *streamFile) {
     return NULL;
 }
 
+/* checks the file ids against the meta's signatures, if any */
+static int is_meta_plausible(VGMSTREAM* (*init_vgmstream_function)(STREAMFILE*), const uint8_t * header) {
+    int i, has_signature = 0;
+    uint32_t id_00 = (uint32_t)get_32bitBE((uint8_t *)header + 0x00);
+    uint32_t id_08 = (uint32_t)get_32bitBE((uint8_t *)header + 0x08);
+
+    for (i = 0; i < sizeof(meta_signatures) / sizeof(meta_signatures[0]); i++) {
+        const meta_signature * signature = &meta_signatures[i];
+        if (signature->init != init_vgmstream_function)
+            continue;
+
+        has_signature = 1;
+        if (signature->id_00 == id_00 && (signature->id_08 == 0 || signature->id_08 == id_08))
+            return 1;
+    }
+
+    return !has_signature;
+}
+
 /* format detection and VGMSTREAM setup, uses default parameters */
 VGMSTREAM * init_vgmstream(const char * const filename) {
     VGMSTREAM *vgmstream = NULL;
@@ -154,7 +199,7 @@ VGMSTREAM * allocate_vgmstream(int channel_count, int looped) {
     VGMSTREAMCHANNEL * loop_channels;
 
     /* up to ~16 aren't too rare for multilayered files, more is probably a bug */
-    if (channel_count <= 0 || channel_count > 64) {
+    if (channel_count <= 0 || channel_count > VGMSTREAM_MAX_CHANNELS) {
         VGM_LOG("VGMSTREAM: error allocating %i channels\n", channel_count);
         return NULL;
     }
@@ -363,14 +408,41 @@ void vgmstream_set_loop_target(VGMSTREAM* vgmstream, int loop_target) {
 }
 
 
+#define RENDER_CONVERT_BUF_SIZE 0x1000
+
 /* Decode data into sample buffer */
 void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream) {
+    render_vgmstream_fmt(buffer, SAMPLE_FMT_S16, sample_count, vgmstream);
+}
+
+/* Checks if the layout+codec can render non-16-bit samples directly (others are converted) */
+static int vgmstream_supports_fmt(VGMSTREAM * vgmstream) {
+    switch (vgmstream->layout_type) {
+        case layout_none:
+            switch (vgmstream->coding_type) {
+#ifdef VGM_USE_VORBIS
+                case coding_OGG_VORBIS:
+                case coding_VORBIS_custom:
+                    return 1;
+#endif
+                default:
+                    return 0;
+            }
+        case layout_segmented: /* each segment/layer converts if needed */
+        case layout_layered:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void render_layout(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
     switch (vgmstream->layout_type) {
         case layout_interleave:
             render_vgmstream_interleave(buffer,sample_count,vgmstream);
             break;
         case layout_none:
-            render_vgmstream_flat(buffer,sample_count,vgmstream);
+            render_vgmstream_flat(buffer,fmt,sample_count,vgmstream);
             break;
         case layout_blocked_mxch:
         case layout_blocked_ast:
@@ -410,20 +482,69 @@ void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstre
         case layout_blocked_sthd:
         case layout_blocked_h4m:
         case layout_segmented:
-            render_vgmstream_segmented(buffer,sample_count,vgmstream);
+            render_vgmstream_segmented(buffer,fmt,sample_count,vgmstream);
             break;
         case layout_layered:
-            render_vgmstream_layered(buffer,sample_count,vgmstream);
+            render_vgmstream_layered(buffer,fmt,sample_count,vgmstream);
             break;
         default:
             break;
     }
+}
+
+/* Renders 16-bit samples in chunks and converts them, for layouts/codecs that only output 16-bit */
+static void render_layout_converted(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
+    sample convert_buf[RENDER_CONVERT_BUF_SIZE];
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
+    int samples_written = 0;
+    int samples_per_buf = RENDER_CONVERT_BUF_SIZE / vgmstream->channels;
+
+    while (samples_written < sample_count) {
+        void * outbuf = get_sample_buffer_offset(buffer, fmt, vgmstream->channels, samples_written, planar_buf);
+        int samples_to_do = samples_per_buf;
+        if (samples_to_do > sample_count - samples_written)
+            samples_to_do = sample_count - samples_written;
+
+        render_layout(convert_buf, SAMPLE_FMT_S16, samples_to_do, vgmstream);
+        if (is_sample_fmt_planar(fmt))
+            deinterleave_samples_s16(outbuf, fmt, convert_buf, vgmstream->channels, samples_to_do);
+        else
+            convert_samples_s16(outbuf, fmt, convert_buf, samples_to_do*vgmstream->channels);
+
+        samples_written += samples_to_do;
+    }
+}
+
+static inline uint8_t * get_sample_ptr(void * buffer, sample_fmt_t fmt, int channels, int32_t s, int ch) {
+    size_t sample_size = get_sample_fmt_size(fmt);
+    if (is_sample_fmt_planar(fmt))
+        return (uint8_t*)((void**)buffer)[ch] + s*sample_size;
+    return (uint8_t*)buffer + (s*channels + ch)*sample_size;
+}
+
+/* Decode data into one buffer per channel. Layouts/codecs that get planar data (ex. Vorbis, layered)
+ * write it directly, avoiding interleaving and deinterleaving it again for callers that need it planar. */
+void render_vgmstream_planar(void ** buffers, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
+    render_vgmstream_fmt(buffers, get_sample_fmt_planar(fmt), sample_count, vgmstream);
+}
+
+/* Decode data into a buffer of any sample format. Float codecs output the format directly
+ * (skipping 16-bit quantization), while the rest are converted from 16-bit. */
+void render_vgmstream_fmt(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream) {
+    size_t sample_size = get_sample_fmt_size(fmt);
+
+    if (fmt != SAMPLE_FMT_S16 && !vgmstream_supports_fmt(vgmstream))
+        render_layout_converted(buffer, fmt, sample_count, vgmstream);
+    else
+        render_layout(buffer, fmt, sample_count, vgmstream);
 
 
     /* swap channels if set, to create custom channel mappings */
     if (vgmstream->channel_mappings_on) {
         int ch_from,ch_to,s;
-        sample temp;
+        uint8_t temp[sizeof(int32_t)];
+        uint8_t * sample_from;
+        uint8_t * sample_to;
         for (s = 0; s < sample_count; s++) {
             for (ch_from = 0; ch_from < vgmstream->channels; ch_from++) {
                 if (ch_from > 32)
@@ -433,9 +554,12 @@ void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstre
                 if (ch_to < 1 || ch_to > 32 || ch_to > vgmstream->channels-1 || ch_from == ch_to)
                     continue;
 
-                temp = buffer[s*vgmstream->channels + ch_from];
-                buffer[s*vgmstream->channels + ch_from] = buffer[s*vgmstream->channels + ch_to];
-                buffer[s*vgmstream->channels + ch_to] = temp;
+                sample_from = get_sample_ptr(buffer, fmt, vgmstream->channels, s, ch_from);
+                sample_to = get_sample_ptr(buffer, fmt, vgmstream->channels, s, ch_to);
+
+                memcpy(temp, sample_from, sample_size);
+                memcpy(sample_from, sample_to, sample_size);
+                memcpy(sample_to, temp, sample_size);
             }
         }
     }
@@ -448,9 +572,113 @@ void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstre
             for (ch = 0; ch < vgmstream->channels; ch++) {
                 if ((vgmstream->channel_mask >> ch) & 1)
                     continue;
-                buffer[s*vgmstream->channels + ch] = 0;
+                memset(get_sample_ptr(buffer, fmt, vgmstream->channels, s, ch), 0, sample_size); /* also 0.0f */
+            }
+        }
+    }
+}
+
+int vgmstream_remux_ogg(VGMSTREAM * vgmstream, vgmstream_write_t write, void * user_data) {
+    if (vgmstream->layout_type != layout_none)
+        return 0;
+
+    switch (vgmstream->coding_type) {
+#ifdef VGM_USE_VORBIS
+        case coding_VORBIS_custom:
+            return vorbis_custom_remux_ogg(vgmstream, write, user_data);
+#endif
+        default:
+            return 0;
+    }
+}
+
+int vgmstream_remux_ogg_fsb(STREAMFILE * streamFile, off_t start_offset, size_t stream_size, int channels, int sample_rate,
+        uint32_t setup_id, int32_t num_samples, vgmstream_write_t write, void * user_data) {
+#ifdef VGM_USE_VORBIS
+    vorbis_custom_config cfg = {0};
+
+    cfg.channels = channels;
+    cfg.sample_rate = sample_rate;
+    cfg.setup_id = setup_id;
+    cfg.stream_size = stream_size;
+
+    return vorbis_custom_remux_ogg_fsb(streamFile, start_offset, &cfg, num_samples, write, user_data);
+#else
+    return 0;
+#endif
+}
+
+int vgmstream_pack_wwise(STREAMFILE * streamFile, vgmstream_write_t write, void * user_data) {
+#ifdef VGM_USE_VORBIS
+    return vorbis_custom_pack_wwise(streamFile, write, user_data);
+#else
+    return 0;
+#endif
+}
+
+/* Decode all remaining samples to a sink. Vorbis codecs go straight to the decoder (no loop/frame
+ * checks per chunk), while others are rendered in chunks with looping disabled. */
+int32_t render_vgmstream_to_end(VGMSTREAM * vgmstream, sample_fmt_t fmt, vgmstream_sink_t sink, void * user_data) {
+    int32_t samples_left = vgmstream->num_samples - vgmstream->current_sample;
+    int32_t samples_done = 0;
+
+    if (samples_left <= 0)
+        return 0;
+
+    if (vgmstream->layout_type == layout_none && !vgmstream->channel_mappings_on && !vgmstream->channel_mask) {
+        switch (vgmstream->coding_type) {
+#ifdef VGM_USE_VORBIS
+            case coding_OGG_VORBIS:
+                samples_done = decode_ogg_vorbis_to_end(vgmstream->codec_data, fmt, vgmstream->channels, samples_left, sink, user_data);
+                vgmstream->current_sample += samples_done;
+                return samples_done;
+
+            case coding_VORBIS_custom:
+                samples_done = decode_vorbis_custom_to_end(vgmstream, fmt, samples_left, sink, user_data);
+                vgmstream->current_sample += samples_done;
+                return samples_done;
+#endif
+            default:
+                break;
+        }
+    }
+
+    /* others: render in chunks */
+    {
+        void * planar_buf[VGMSTREAM_MAX_CHANNELS];
+        size_t sample_size = get_sample_fmt_size(fmt);
+        int loop_flag = vgmstream->loop_flag;
+        void * outbuf;
+        uint8_t * buf;
+        int ch;
+
+        buf = malloc(RENDER_CONVERT_BUF_SIZE * vgmstream->channels * sample_size);
+        if (!buf) return 0;
+
+        outbuf = buf;
+        if (is_sample_fmt_planar(fmt)) {
+            for (ch = 0; ch < vgmstream->channels; ch++) {
+                planar_buf[ch] = buf + ch * RENDER_CONVERT_BUF_SIZE * sample_size;
             }
+            outbuf = planar_buf;
         }
+
+        vgmstream->loop_flag = 0;
+        while (samples_done < samples_left) {
+            int32_t samples_to_do = RENDER_CONVERT_BUF_SIZE;
+            if (samples_to_do > samples_left - samples_done)
+                samples_to_do = samples_left - samples_done;
+
+            render_vgmstream_fmt(outbuf, fmt, samples_to_do, vgmstream);
+            samples_done += samples_to_do;
+
+            if (!sink(user_data, outbuf, fmt, samples_to_do, vgmstream->channels))
+                break;
+        }
+        vgmstream->loop_flag = loop_flag;
+
+        free(buf);
+        return samples_done;
     }
 }
 
@@ -811,15 +1039,23 @@ int get_vgmstream_shortframe_size(VGMSTREAM * vgmstream) {
 /* Decode samples into the buffer. Assume that we have written samples_written into the
  * buffer already, and we have samples_to_do consecutive samples ahead of us. */
 void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer) {
+    decode_vgmstream_fmt(vgmstream, samples_written, samples_to_do, buffer, SAMPLE_FMT_S16);
+}
+
+/* Same as decode_vgmstream, for any sample format (only for codecs in vgmstream_supports_fmt, others must use S16) */
+void decode_vgmstream_fmt(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, void * buffer, sample_fmt_t fmt) {
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
+    void * outbuf = get_sample_buffer_offset(buffer, fmt, vgmstream->channels, samples_written, planar_buf);
+
     switch (vgmstream->coding_type) {
 #ifdef VGM_USE_VORBIS
         case coding_OGG_VORBIS:
-            decode_ogg_vorbis(vgmstream->codec_data, buffer+samples_written*vgmstream->channels,
+            decode_ogg_vorbis_fmt(vgmstream->codec_data, outbuf, fmt,
                     samples_to_do,vgmstream->channels);
             break;
 
         case coding_VORBIS_custom:
-            decode_vorbis_custom(vgmstream, buffer+samples_written*vgmstream->channels,
+            decode_vorbis_custom_fmt(vgmstream, outbuf, fmt,
                     samples_to_do,vgmstream->channels);
             break;
 #endif
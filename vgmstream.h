@@ -11,6 +11,7 @@
 
 enum { PATH_LIMIT = 32768 };
 enum { STREAM_NAME_SIZE = 255 }; /* reasonable max */
+enum { VGMSTREAM_MAX_CHANNELS = 64 };
 
 #include "streamfile.h"
 
@@ -26,6 +27,7 @@ enum { STREAM_NAME_SIZE = 255 }; /* reasonable max */
 //#define VGM_USE_FFMPEG
 //#define VGM_USE_ATRAC9
 //#define VGM_USE_CELT
+//#define VGM_USE_IO_URING /* async prefetch of file reads (Linux, liburing), not a codec */
 
 
 #ifdef VGM_USE_VORBIS
@@ -826,15 +828,41 @@ typedef struct {
     wwise_header_t header_type;
     wwise_packet_t packet_type;
 
+    /* Wwise Vorbis: audio packets location, to index them on init (optional) */
+    off_t stream_offset;
+    size_t stream_size;
+    /* Wwise Vorbis: seek table location (optional) */
+    off_t seek_table_offset;
+    size_t seek_table_size;
+
     /* output (kinda ugly here but to simplify) */
     off_t data_start_offset;
 
 } vorbis_custom_config;
 
+/* custom Vorbis packet info, precomputed in a single pass to avoid re-reading headers when decoding */
+typedef struct {
+    off_t offset;               /* packet start (including the custom header) */
+    uint32_t packet_size;       /* size of the Vorbis data, without header */
+    uint8_t header_size;
+    uint8_t mode_number;
+    uint8_t blockflag;          /* long/short window */
+    uint8_t prev_blockflag;     /* window flags of adjacent packets (for modified packets) */
+    uint8_t next_blockflag;
+} vorbis_custom_packet;
+
+/* custom Vorbis seek point: after a restart, decoding from offset outputs samples from sample onwards */
+typedef struct {
+    int32_t sample;
+    off_t offset;
+} vorbis_custom_seek;
+
 /* custom Vorbis without Ogg layer */
+typedef struct vorbis_custom_info vorbis_custom_info;
 typedef struct {
-    vorbis_info vi;             /* stream settings */
-    vorbis_comment vc;          /* stream comments */
+    vorbis_info * vi;           /* stream settings (shared with other streams using the same headers) */
+    vorbis_comment * vc;        /* stream comments (same) */
+    vorbis_custom_info * info;  /* shared vi/vc owner */
     vorbis_dsp_state vd;        /* decoder global state */
     vorbis_block vb;            /* decoder local state */
     ogg_packet op;              /* fake packet for internal use */
@@ -852,6 +880,14 @@ typedef struct {
     uint8_t mode_blockflag[64+1];   /* max 6b+1; flags 'n stuff */
     int mode_bits;                  /* bits to store mode_number */
     uint8_t prev_blockflag;         /* blockflag in the last decoded packet */
+    vorbis_custom_packet * packets; /* packet index (optional) */
+    int packet_count;
+    int packet_current;             /* index of the next expected packet */
+    /* seek points sorted by sample (optional) */
+    vorbis_custom_seek * seek_table;
+    int seek_count;
+    int seek_table_scanned;         /* flag, seek points were synthesized (or tried) */
+    uint64_t cache_key;             /* to save indexes to the cache (0 = none) */
     /* Ogg-style Vorbis: packet within a page */
     int current_packet;
     /* reference for page/blocks */
@@ -860,6 +896,11 @@ typedef struct {
 
     int prev_block_samples;     /* count for optimization */
 
+    /* header packets collected during setup, to find/make the shared vi/vc */
+    uint8_t * header_data;
+    size_t header_sizes[3];
+    int header_count;
+
 } vorbis_custom_codec_data;
 #endif
 
@@ -961,6 +1002,37 @@ int32_t get_vgmstream_play_samples(double looptimes, double fadeseconds, double
 /* Decode data into sample buffer */
 void render_vgmstream(sample * buffer, int32_t sample_count, VGMSTREAM * vgmstream);
 
+/* Decode data into a buffer of samples in fmt (int32_t/float, sample_count * channels).
+ * Codecs that decode to float output it directly, instead of quantizing to 16-bit first. */
+void render_vgmstream_fmt(void * buffer, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream);
+
+/* Decode data into one buffer per channel (sample_count each), in fmt or its planar variant. */
+void render_vgmstream_planar(void ** buffers, sample_fmt_t fmt, int32_t sample_count, VGMSTREAM * vgmstream);
+
+/* Receives samples from render_vgmstream_to_end (buffer as in render_vgmstream_fmt, only valid during the call).
+ * Returns 0 to stop decoding. */
+typedef int (*vgmstream_sink_t)(void * user_data, void * buffer, sample_fmt_t fmt, int32_t sample_count, int channels);
+
+/* Receives bytes from remux functions. Returns 0 on error (stops remuxing). */
+typedef int (*vgmstream_write_t)(void * user_data, const uint8_t * buf, size_t size);
+
+/* Write the stream as a standard Ogg Vorbis file without decoding, if the codec allows it (custom Vorbis).
+ * Resets the stream. Returns 1 if the whole stream was written. */
+int vgmstream_remux_ogg(VGMSTREAM * vgmstream, vgmstream_write_t write, void * user_data);
+
+/* Write a FSB Vorbis stream (FSB5 subsong, from its header values) as a standard Ogg Vorbis file, without
+ * opening it as a VGMSTREAM, for batch conversions of whole banks. Returns 1 if the whole stream was written. */
+int vgmstream_remux_ogg_fsb(STREAMFILE * streamFile, off_t start_offset, size_t stream_size, int channels, int sample_rate,
+        uint32_t setup_id, int32_t num_samples, vgmstream_write_t write, void * user_data);
+
+/* Write an Ogg Vorbis file as a Wwise .wem without re-encoding (codebooks must be in the aoTuV library
+ * Wwise uses). Returns 1 if the whole file was written. */
+int vgmstream_pack_wwise(STREAMFILE * streamFile, vgmstream_write_t write, void * user_data);
+
+/* Decode all samples from the current position to the end of the stream (ignoring loops) into a sink,
+ * in whatever chunks the codec decodes. Meant for whole-file transcodes. Returns samples done. */
+int32_t render_vgmstream_to_end(VGMSTREAM * vgmstream, sample_fmt_t fmt, vgmstream_sink_t sink, void * user_data);
+
 /* Write a description of the stream into array pointed by desc, which must be length bytes long.
  * Will always be null-terminated if length > 0 */
 void describe_vgmstream(VGMSTREAM * vgmstream, char * desc, int length);
@@ -997,6 +1069,7 @@ int get_vgmstream_shortframe_size(VGMSTREAM * vgmstream);
 /* Decode samples into the buffer. Assume that we have written samples_written into the
  * buffer already, and we have samples_to_do consecutive samples ahead of us. */
 void decode_vgmstream(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, sample * buffer);
+void decode_vgmstream_fmt(VGMSTREAM * vgmstream, int samples_written, int samples_to_do, void * buffer, sample_fmt_t fmt);
 
 /* Calculate number of consecutive samples to do (taking into account stopping for loop start and end) */
 int vgmstream_samples_to_do(int samples_this_block, int samples_per_frame, VGMSTREAM * vgmstream);
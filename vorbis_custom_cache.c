@@ -0,0 +1,298 @@
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+#include "vorbis_custom_decoder.h"
+
+#ifdef VGM_USE_VORBIS
+
+/* Optional on-disk cache of custom Vorbis indexes (packet index and seek table), since building them
+ * needs a full scan of packet headers. Files are named after a key made from the file size, a hash of
+ * the file's start, and the decoder config, so modified or different files/subsongs won't match.
+ *
+ * Format (all LE, fixed size records so it can be mapped directly):
+ * - 0x00: "VCIX"
+ * - 0x04: version
+ * - 0x08: key (64b)
+ * - 0x10: packet count
+ * - 0x14: seek count
+ * - 0x18: flags (0x01: seek table was scanned)
+ * - 0x1c: reserved
+ * - 0x20: packets (0x10 each): offset(64b), packet size(32b), header size(8b), mode number(8b), window flags(8b), reserved(8b)
+ * - then: seek points (0x10 each): offset(64b), sample(32b), reserved(32b)
+ */
+
+#define VORBIS_CACHE_VERSION 1
+#define VORBIS_CACHE_HEADER_SIZE 0x20
+#define VORBIS_CACHE_ENTRY_SIZE 0x10
+#define VORBIS_CACHE_HASH_SIZE 0x1000 /* enough to cover headers and setup */
+
+static char cache_dir[PATH_LIMIT] = {0};
+
+
+/* Sets a dir to load/save custom Vorbis indexes (NULL or empty to disable). Not thread safe, should be set once on startup. */
+void vorbis_custom_set_cache_dir(const char * dir) {
+    if (!dir) {
+        cache_dir[0] = '\0';
+        return;
+    }
+    strncpy(cache_dir, dir, sizeof(cache_dir));
+    cache_dir[sizeof(cache_dir) - 1] = '\0';
+}
+
+static void put_64bitLE(uint8_t * buf, uint64_t value) {
+    put_32bitLE(buf + 0x00, (int32_t)(value >> 0));
+    put_32bitLE(buf + 0x04, (int32_t)(value >> 32));
+}
+
+static uint64_t hash_value(uint64_t hash, uint64_t value) {
+    uint8_t buf[0x08];
+    put_64bitLE(buf, value);
+    return hash_fnv1a(hash, buf, sizeof(buf));
+}
+
+static void get_cache_path(char * path, size_t path_size, uint64_t key) {
+    snprintf(path, path_size, "%s/%08x%08x.vcix", cache_dir, (uint32_t)(key >> 32), (uint32_t)(key >> 0));
+}
+
+/* Checks loaded indexes against the current stream and setup, as the key can collide and files can be
+ * stale or damaged (a bad index would make the decoder read garbage instead of just seeking badly). */
+static int is_cache_valid(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data,
+        vorbis_custom_packet * packets, int packet_count, vorbis_custom_seek * seek_table, int seek_count) {
+    off_t stream_start = data->config.stream_offset;
+    off_t stream_end = data->config.stream_offset + data->config.stream_size;
+    size_t file_size = get_streamfile_size(streamFile);
+    int i;
+
+    if (!data->config.stream_size) { /* not all formats set it */
+        stream_start = start_offset;
+        stream_end = file_size;
+    }
+    if (stream_end > file_size) /* truncated/prefetch files */
+        stream_end = file_size;
+
+    /* packets must be contiguous from the stream start, with modes from the current setup */
+    if (packet_count) {
+        if (!data->config.stream_size || packets[0].offset != data->config.stream_offset)
+            return 0;
+
+        for (i = 0; i < packet_count; i++) {
+            vorbis_custom_packet * packet = &packets[i];
+            off_t packet_end = packet->offset + packet->header_size + packet->packet_size;
+
+            if (packet_end > stream_end)
+                return 0;
+            if (i + 1 < packet_count && packet_end != packets[i+1].offset)
+                return 0;
+
+            if (packet->packet_size > 0) {
+                if (packet->mode_number >= (1 << data->mode_bits))
+                    return 0;
+                if (packet->blockflag != data->mode_blockflag[packet->mode_number])
+                    return 0;
+            }
+            else if (packet->mode_number != 0 || packet->blockflag != 0) {
+                return 0;
+            }
+
+            if (packet->prev_blockflag != ((i > 0) ? packets[i-1].blockflag : 0))
+                return 0;
+            if (packet->next_blockflag != ((i + 1 < packet_count) ? packets[i+1].blockflag : 0))
+                return 0;
+        }
+    }
+
+    /* seek points must be in the stream and sorted (found with a binary search) */
+    for (i = 0; i < seek_count; i++) {
+        if (seek_table[i].offset < stream_start || seek_table[i].offset >= stream_end)
+            return 0;
+        if (seek_table[i].sample < 0 || (i > 0 && seek_table[i].sample < seek_table[i-1].sample))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+/* Loads indexes from the cache, if found. Also sets the key to save them later. */
+int vorbis_custom_cache_load(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data) {
+    char path[PATH_LIMIT];
+    uint8_t header[VORBIS_CACHE_HEADER_SIZE];
+    uint8_t * buf = NULL;
+    vorbis_custom_packet * packets = NULL;
+    vorbis_custom_seek * seek_table = NULL;
+    FILE * file = NULL;
+    uint64_t key;
+    int packet_count, seek_count, flags, i;
+    size_t buf_size;
+
+    if (!cache_dir[0])
+        return 0;
+
+    /* make key */
+    {
+        uint8_t hbuf[VORBIS_CACHE_HASH_SIZE];
+        size_t file_size = get_streamfile_size(streamFile);
+        size_t bytes = read_streamfile(hbuf, 0x00, sizeof(hbuf), streamFile);
+
+        key = hash_fnv1a(VGM_HASH_INIT, hbuf, bytes);
+        key = hash_value(key, file_size);
+        key = hash_value(key, start_offset);
+        key = hash_value(key, data->type);
+        key = hash_value(key, data->config.setup_type);
+        key = hash_value(key, data->config.header_type);
+        key = hash_value(key, data->config.packet_type);
+        key = hash_value(key, data->config.channels);
+        key = hash_value(key, data->config.stream_offset);
+        key = hash_value(key, data->config.stream_size);
+        if (key == 0) key = 1; /* 0 = no key */
+        data->cache_key = key;
+    }
+
+    get_cache_path(path, sizeof(path), key);
+    file = fopen(path, "rb");
+    if (!file) goto fail;
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) goto fail;
+    if (get_32bitBE(header + 0x00) != 0x56434958) goto fail; /* "VCIX" */
+    if (get_32bitLE(header + 0x04) != VORBIS_CACHE_VERSION) goto fail;
+    if ((uint64_t)get_64bitLE(header + 0x08) != key) goto fail;
+    packet_count = get_32bitLE(header + 0x10);
+    seek_count = get_32bitLE(header + 0x14);
+    flags = get_32bitLE(header + 0x18);
+    if (packet_count < 0 || packet_count > 0x1000000 || seek_count < 0 || seek_count > 0x1000000) goto fail;
+
+    buf_size = (packet_count + seek_count) * VORBIS_CACHE_ENTRY_SIZE;
+    if (buf_size) {
+        buf = malloc(buf_size);
+        if (!buf) goto fail;
+        if (fread(buf, 1, buf_size, file) != buf_size) goto fail;
+    }
+
+    if (packet_count) {
+        packets = malloc(packet_count * sizeof(vorbis_custom_packet));
+        if (!packets) goto fail;
+
+        for (i = 0; i < packet_count; i++) {
+            uint8_t * entry = buf + i * VORBIS_CACHE_ENTRY_SIZE;
+            uint8_t window_flags = entry[0x0e];
+
+            packets[i].offset = (off_t)get_64bitLE(entry + 0x00);
+            packets[i].packet_size = (uint32_t)get_32bitLE(entry + 0x08);
+            packets[i].header_size = entry[0x0c];
+            packets[i].mode_number = entry[0x0d];
+            packets[i].blockflag = (window_flags >> 0) & 1;
+            packets[i].prev_blockflag = (window_flags >> 1) & 1;
+            packets[i].next_blockflag = (window_flags >> 2) & 1;
+        }
+    }
+
+    if (seek_count) {
+        seek_table = malloc(seek_count * sizeof(vorbis_custom_seek));
+        if (!seek_table) goto fail;
+
+        for (i = 0; i < seek_count; i++) {
+            uint8_t * entry = buf + (packet_count + i) * VORBIS_CACHE_ENTRY_SIZE;
+
+            seek_table[i].offset = (off_t)get_64bitLE(entry + 0x00);
+            seek_table[i].sample = get_32bitLE(entry + 0x08);
+        }
+    }
+
+    fclose(file);
+    file = NULL;
+
+    if (!is_cache_valid(streamFile, start_offset, data, packets, packet_count, seek_table, seek_count)) {
+        VGM_LOG("VORBIS: ignored invalid index cache %s\n", path);
+        goto fail;
+    }
+
+    free(buf);
+
+    free(data->packets);
+    data->packets = packets;
+    data->packet_count = packet_count;
+    data->packet_current = 0;
+    free(data->seek_table);
+    data->seek_table = seek_table;
+    data->seek_count = seek_count;
+    data->seek_table_scanned = flags & 0x01;
+    return 1;
+
+fail:
+    if (file) fclose(file);
+    free(buf);
+    free(packets);
+    free(seek_table);
+    return 0;
+}
+
+/* Saves current indexes to the cache (written to a temp file first, as other processes may be reading it). */
+int vorbis_custom_cache_save(vorbis_custom_codec_data *data) {
+    char path[PATH_LIMIT], temp_path[PATH_LIMIT];
+    uint8_t header[VORBIS_CACHE_HEADER_SIZE];
+    uint8_t entry[VORBIS_CACHE_ENTRY_SIZE];
+    FILE * file = NULL;
+    int i;
+
+    if (!cache_dir[0] || !data->cache_key)
+        return 0;
+
+    get_cache_path(path, sizeof(path), data->cache_key);
+#ifndef _MSC_VER
+    snprintf(temp_path, sizeof(temp_path), "%s.%u.%p.tmp", path, (unsigned)getpid(), (void*)data); /* unique per process/stream */
+#else
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+#endif
+
+    file = fopen(temp_path, "wb");
+    if (!file) goto fail;
+
+    memset(header, 0, sizeof(header));
+    put_32bitBE(header + 0x00, 0x56434958); /* "VCIX" */
+    put_32bitLE(header + 0x04, VORBIS_CACHE_VERSION);
+    put_64bitLE(header + 0x08, data->cache_key);
+    put_32bitLE(header + 0x10, data->packet_count);
+    put_32bitLE(header + 0x14, data->seek_count);
+    put_32bitLE(header + 0x18, data->seek_table_scanned ? 0x01 : 0x00);
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) goto fail;
+
+    for (i = 0; i < data->packet_count; i++) {
+        vorbis_custom_packet * packet = &data->packets[i];
+
+        memset(entry, 0, sizeof(entry));
+        put_64bitLE(entry + 0x00, packet->offset);
+        put_32bitLE(entry + 0x08, packet->packet_size);
+        entry[0x0c] = packet->header_size;
+        entry[0x0d] = packet->mode_number;
+        entry[0x0e] = (packet->blockflag << 0) | (packet->prev_blockflag << 1) | (packet->next_blockflag << 2);
+        if (fwrite(entry, 1, sizeof(entry), file) != sizeof(entry)) goto fail;
+    }
+
+    for (i = 0; i < data->seek_count; i++) {
+        memset(entry, 0, sizeof(entry));
+        put_64bitLE(entry + 0x00, data->seek_table[i].offset);
+        put_32bitLE(entry + 0x08, data->seek_table[i].sample);
+        if (fwrite(entry, 1, sizeof(entry), file) != sizeof(entry)) goto fail;
+    }
+
+    if (fclose(file) != 0) {
+        file = NULL;
+        goto fail;
+    }
+    file = NULL;
+
+#ifdef _MSC_VER
+    remove(path); /* rename doesn't overwrite */
+#endif
+    if (rename(temp_path, path) != 0) goto fail;
+
+    return 1;
+
+fail:
+    VGM_LOG("VORBIS: couldn't save index cache %s\n", path);
+    if (file) fclose(file);
+    remove(temp_path);
+    return 0;
+}
+
+#endif
@@ -19777,168 +19777,169 @@ static const uint8_t fvs_1c08a6ff[] = {
 };
 
 
+/* sorted by id, for binary search */
 static const fvs_info fvs_list[] = {
-    {0xa72297ff,0x16c0,fvs_a72297ff},
-    {0x69ef6302,0x0f15,fvs_69ef6302},
-    {0x3660a305,0x0ef8,fvs_3660a305},
+    {0x070ba3b6,0x0c05,fvs_070ba3b6},
+    {0x08474b3b,0x0bbe,fvs_08474b3b},
+    {0x0e05b915,0x16c0,fvs_0e05b915},
+    {0x0f2f7d68,0x1488,fvs_0f2f7d68},
+    {0x14be1423,0x0ed4,fvs_14be1423},
+    {0x1751f4d5,0x0c75,fvs_1751f4d5},
+    {0x17e106f5,0x0ed4,fvs_17e106f5},
+    {0x19ea2884,0x0eb3,fvs_19ea2884},
     {0x1bbad506,0x102c,fvs_1bbad506},
-    {0x5d041107,0x0c75,fvs_5d041107},
-    {0x56e8ad09,0x0f50,fvs_56e8ad09},
+    {0x1c08a6ff,0x0c75,fvs_1c08a6ff},
+    {0x1f2df74f,0x0eb3,fvs_1f2df74f},
     {0x1f80570a,0x0c05,fvs_1f80570a},
-    {0x49fd480c,0x1488,fvs_49fd480c},
-    {0x92d31401,0x0ed4,fvs_92d31401},
-    {0xaee2590e,0x0c05,fvs_aee2590e},
-    {0x7973eb10,0x0c05,fvs_7973eb10},
-    {0xb720b682,0x0c05,fvs_b720b682},
-    {0xd8220d13,0x0c05,fvs_d8220d13},
-    {0x0e05b915,0x16c0,fvs_0e05b915},
-    {0xc55efa16,0x0ddb,fvs_c55efa16},
-    {0x3bf54b18,0x0ef8,fvs_3bf54b18},
-    {0x6288f31b,0x0eb3,fvs_6288f31b},
     {0x1fdf9e1c,0x0eb3,fvs_1fdf9e1c},
-    {0x9f46fc1c,0x0ed4,fvs_9f46fc1c},
-    {0x273faa21,0x0eb3,fvs_273faa21},
-    {0xf675b121,0x16c0,fvs_f675b121},
-    {0x14be1423,0x0ed4,fvs_14be1423},
-    {0xd1bf11df,0x0d9c,fvs_d1bf11df},
-    {0x3ffea827,0x16c0,fvs_3ffea827},
-    {0xb00da327,0x0ef8,fvs_b00da327},
-    {0xc4c30a29,0x0ef8,fvs_c4c30a29},
-    {0x6b01ef2b,0x102c,fvs_6b01ef2b},
-    {0x4f739c2d,0x0bbe,fvs_4f739c2d},
-    {0x6c87a72f,0x1081,fvs_6c87a72f},
-    {0xf337612f,0x0ebb,fvs_f337612f},
-    {0x7d121031,0x0d84,fvs_7d121031},
-    {0xcd089432,0x0d24,fvs_cd089432},
-    {0x2f8dd637,0x0d25,fvs_2f8dd637},
-    {0x6760a9b4,0x0886,fvs_6760a9b4},
-    {0xd73c3039,0x0dc8,fvs_d73c3039},
-    {0x08474b3b,0x0bbe,fvs_08474b3b},
+    {0x203c9fa1,0x0d9c,fvs_203c9fa1},
+    {0x20591e7a,0x1081,fvs_20591e7a},
     {0x2594af3c,0x16c0,fvs_2594af3c},
+    {0x273faa21,0x0eb3,fvs_273faa21},
+    {0x28f00387,0x0d9c,fvs_28f00387},
+    {0x29d547a7,0x0ebb,fvs_29d547a7},
     {0x2a3a190a,0x0d24,fvs_2a3a190a},
-    {0x6d39bf3e,0x0f44,fvs_6d39bf3e},
-    {0xb62ad8df,0x0fc6,fvs_b62ad8df},
-    {0x90ac8c41,0x16c0,fvs_90ac8c41},
-    {0x30efa143,0x0d9c,fvs_30efa143},
+    {0x2a685fc6,0x0d24,fvs_2a685fc6},
     {0x2ba1a444,0x0d84,fvs_2ba1a444},
-    {0x4ca44146,0x0eb3,fvs_4ca44146},
-    {0x8e53ea46,0x0c75,fvs_8e53ea46},
+    {0x2f8dd637,0x0d25,fvs_2f8dd637},
+    {0x30efa143,0x0d9c,fvs_30efa143},
+    {0x329e91b4,0x1488,fvs_329e91b4},
+    {0x355295ca,0x0c75,fvs_355295ca},
+    {0x35a86f68,0x0c05,fvs_35a86f68},
+    {0x3660a305,0x0ef8,fvs_3660a305},
+    {0x3747f5e3,0x0d84,fvs_3747f5e3},
+    {0x38aa59ce,0x0ef8,fvs_38aa59ce},
+    {0x39e4f39a,0x09aa,fvs_39e4f39a},
+    {0x3bf54b18,0x0ef8,fvs_3bf54b18},
+    {0x3f0c8399,0x16c0,fvs_3f0c8399},
+    {0x3f2e053b,0x0d24,fvs_3f2e053b},
+    {0x3f4f6b79,0x0eb3,fvs_3f4f6b79},
     {0x3f65b737,0x0a0f,fvs_3f65b737},
-    {0xf234b061,0x0d24,fvs_f234b061},
-    {0x1f2df74f,0x0eb3,fvs_1f2df74f},
-    {0xcb5df64f,0x0eb3,fvs_cb5df64f},
-    {0x6b88bd52,0x0ebb,fvs_6b88bd52},
-    {0xdddcadec,0x0d84,fvs_dddcadec},
-    {0x571c7954,0x0ed7,fvs_571c7954},
-    {0xad11d38d,0x0d9c,fvs_ad11d38d},
-    {0x961f2e55,0x102c,fvs_961f2e55},
-    {0x8da25e57,0x0a0f,fvs_8da25e57},
-    {0xb370dc94,0x0d24,fvs_b370dc94},
-    {0x988e56d5,0x0d9c,fvs_988e56d5},
+    {0x3f7c41c1,0x0ed4,fvs_3f7c41c1},
+    {0x3ffea827,0x16c0,fvs_3ffea827},
+    {0x41e240a0,0x0c75,fvs_41e240a0},
+    {0x4218067e,0x0eb3,fvs_4218067e},
     {0x434d925c,0x16c0,fvs_434d925c},
-    {0x76c75260,0x0eb3,fvs_76c75260},
-    {0x796c4262,0x0ef8,fvs_796c4262},
-    {0x3f2e053b,0x0d24,fvs_3f2e053b},
-    {0x9650d164,0x1081,fvs_9650d164},
-    {0xb7946790,0x0eb3,fvs_b7946790},
-    {0x0f2f7d68,0x1488,fvs_0f2f7d68},
-    {0xa68da568,0x102c,fvs_a68da568},
-    {0xf13ee569,0x0eb3,fvs_f13ee569},
-    {0xad60cd6a,0x0d25,fvs_ad60cd6a},
-    {0x84ca616c,0x0c05,fvs_84ca616c},
+    {0x49fd480c,0x1488,fvs_49fd480c},
+    {0x4bb2e8cf,0x0ed4,fvs_4bb2e8cf},
+    {0x4c64f0c0,0x0ef8,fvs_4c64f0c0},
+    {0x4ca44146,0x0eb3,fvs_4ca44146},
+    {0x4d3abd9e,0x0eb3,fvs_4d3abd9e},
     {0x4dec603d,0x0eb8,fvs_4dec603d},
-    {0x35a86f68,0x0c05,fvs_35a86f68},
-    {0xf20a3571,0x0c05,fvs_f20a3571},
+    {0x4f739c2d,0x0bbe,fvs_4f739c2d},
+    {0x55780f8f,0x0ed4,fvs_55780f8f},
+    {0x56e8ad09,0x0f50,fvs_56e8ad09},
+    {0x571c7954,0x0ed7,fvs_571c7954},
+    {0x5949b893,0x0a50,fvs_5949b893},
+    {0x59d5bef9,0x16c0,fvs_59d5bef9},
+    {0x5d041107,0x0c75,fvs_5d041107},
+    {0x61f44196,0x0d84,fvs_61f44196},
+    {0x6288f31b,0x0eb3,fvs_6288f31b},
+    {0x632b1fac,0x0bbe,fvs_632b1fac},
+    {0x64bd4583,0x0eb3,fvs_64bd4583},
+    {0x64d54a7c,0x0a0f,fvs_64d54a7c},
+    {0x6760a9b4,0x0886,fvs_6760a9b4},
+    {0x682eafcb,0x16c0,fvs_682eafcb},
     {0x68dc8475,0x16c0,fvs_68dc8475},
+    {0x690dd8ab,0x0d9c,fvs_690dd8ab},
+    {0x696c5fe9,0x0ef8,fvs_696c5fe9},
+    {0x69ef6302,0x0f15,fvs_69ef6302},
+    {0x6a5436bf,0x0dc8,fvs_6a5436bf},
+    {0x6aad13bc,0x0d84,fvs_6aad13bc},
+    {0x6b01ef2b,0x102c,fvs_6b01ef2b},
+    {0x6b88bd52,0x0ebb,fvs_6b88bd52},
+    {0x6c87a72f,0x1081,fvs_6c87a72f},
+    {0x6d1cdf90,0x102c,fvs_6d1cdf90},
+    {0x6d39bf3e,0x0f44,fvs_6d39bf3e},
+    {0x6e53e4a3,0x0ed4,fvs_6e53e4a3},
+    {0x704fb87e,0x0bbe,fvs_704fb87e},
+    {0x7244a8d0,0x16c0,fvs_7244a8d0},
+    {0x744ca4d0,0x1488,fvs_744ca4d0},
+    {0x76c75260,0x0eb3,fvs_76c75260},
+    {0x782ee3ee,0x0c75,fvs_782ee3ee},
+    {0x7913ed7f,0x1488,fvs_7913ed7f},
+    {0x796c4262,0x0ef8,fvs_796c4262},
+    {0x7973eb10,0x0c05,fvs_7973eb10},
     {0x7bab8576,0x0d9c,fvs_7bab8576},
-    {0x89803b76,0x0d9c,fvs_89803b76},
-    {0x3f4f6b79,0x0eb3,fvs_3f4f6b79},
-    {0x20591e7a,0x1081,fvs_20591e7a},
+    {0x7c8d7518,0x0ef8,fvs_7c8d7518},
+    {0x7d121031,0x0d84,fvs_7d121031},
     {0x7d6d597b,0x102c,fvs_7d6d597b},
-    {0x64d54a7c,0x0a0f,fvs_64d54a7c},
-    {0xbf3afb7c,0x1488,fvs_bf3afb7c},
-    {0x4218067e,0x0eb3,fvs_4218067e},
-    {0x7913ed7f,0x1488,fvs_7913ed7f},
-    {0xc2ea917f,0x102c,fvs_c2ea917f},
-    {0xf2781a42,0x102c,fvs_f2781a42},
-    {0x64bd4583,0x0eb3,fvs_64bd4583},
-    {0x19ea2884,0x0eb3,fvs_19ea2884},
-    {0x9e8a1a84,0x0d25,fvs_9e8a1a84},
-    {0x28f00387,0x0d9c,fvs_28f00387},
-    {0x84d3ac87,0x0c75,fvs_84d3ac87},
+    {0x7de548bb,0x0ed4,fvs_7de548bb},
+    {0x7fc2bbef,0x1081,fvs_7fc2bbef},
+    {0x828b17a0,0x1488,fvs_828b17a0},
     {0x82d3098a,0x0ed4,fvs_82d3098a},
-    {0xb6b3868b,0x0ef8,fvs_b6b3868b},
-    {0x704fb87e,0x0bbe,fvs_704fb87e},
-    {0x8d00698d,0x0fb4,fvs_8d00698d},
-    {0x55780f8f,0x0ed4,fvs_55780f8f},
-    {0x6d1cdf90,0x102c,fvs_6d1cdf90},
-    {0x7c8d7518,0x0ef8,fvs_7c8d7518},
-    {0x5949b893,0x0a50,fvs_5949b893},
     {0x84199294,0x0bbe,fvs_84199294},
-    {0x61f44196,0x0d84,fvs_61f44196},
-    {0xcac30a97,0x0eb3,fvs_cac30a97},
-    {0x3f0c8399,0x16c0,fvs_3f0c8399},
-    {0x39e4f39a,0x09aa,fvs_39e4f39a},
+    {0x84ca616c,0x0c05,fvs_84ca616c},
+    {0x84d3ac87,0x0c75,fvs_84d3ac87},
+    {0x84e079ce,0x0eb3,fvs_84e079ce},
+    {0x87c121d5,0x102c,fvs_87c121d5},
+    {0x89803b76,0x0d9c,fvs_89803b76},
+    {0x8a34a0e4,0x16c0,fvs_8a34a0e4},
+    {0x8c957fd1,0x0e77,fvs_8c957fd1},
+    {0x8d00698d,0x0fb4,fvs_8d00698d},
+    {0x8da25e57,0x0a0f,fvs_8da25e57},
+    {0x8e53ea46,0x0c75,fvs_8e53ea46},
     {0x90021eee,0x102c,fvs_90021eee},
-    {0xe3a83899,0x0eb8,fvs_e3a83899},
-    {0x4d3abd9e,0x0eb3,fvs_4d3abd9e},
-    {0x41e240a0,0x0c75,fvs_41e240a0},
-    {0x203c9fa1,0x0d9c,fvs_203c9fa1},
-    {0x6e53e4a3,0x0ed4,fvs_6e53e4a3},
+    {0x90ac8c41,0x16c0,fvs_90ac8c41},
     {0x910d8ea5,0x0bbe,fvs_910d8ea5},
-    {0x29d547a7,0x0ebb,fvs_29d547a7},
-    {0xb6f8f21b,0x0eb3,fvs_b6f8f21b},
-    {0x690dd8ab,0x0d9c,fvs_690dd8ab},
-    {0x632b1fac,0x0bbe,fvs_632b1fac},
-    {0xf42a8ff1,0x0ef8,fvs_f42a8ff1},
-    {0xc77c8bad,0x16c0,fvs_c77c8bad},
-    {0xcbaf9f1c,0x0eb3,fvs_cbaf9f1c},
-    {0xbe82e3b1,0x0e63,fvs_be82e3b1},
+    {0x92d31401,0x0ed4,fvs_92d31401},
+    {0x95f09cdf,0x0d9c,fvs_95f09cdf},
+    {0x961f2e55,0x102c,fvs_961f2e55},
+    {0x9650d164,0x1081,fvs_9650d164},
     {0x977d3546,0x0bbe,fvs_977d3546},
-    {0x329e91b4,0x1488,fvs_329e91b4},
-    {0xa1a5b6cd,0x16c0,fvs_a1a5b6cd},
-    {0x070ba3b6,0x0c05,fvs_070ba3b6},
-    {0xd7913109,0x0eb8,fvs_d7913109},
-    {0x7de548bb,0x0ed4,fvs_7de548bb},
-    {0x6aad13bc,0x0d84,fvs_6aad13bc},
-    {0x6a5436bf,0x0dc8,fvs_6a5436bf},
-    {0x4c64f0c0,0x0ef8,fvs_4c64f0c0},
-    {0x3f7c41c1,0x0ed4,fvs_3f7c41c1},
-    {0xe6f41e4a,0x0ed4,fvs_e6f41e4a},
-    {0x2a685fc6,0x0d24,fvs_2a685fc6},
-    {0x828b17a0,0x1488,fvs_828b17a0},
-    {0x355295ca,0x0c75,fvs_355295ca},
-    {0x682eafcb,0x16c0,fvs_682eafcb},
     {0x9835fd20,0x0c75,fvs_9835fd20},
-    {0x38aa59ce,0x0ef8,fvs_38aa59ce},
-    {0x4bb2e8cf,0x0ed4,fvs_4bb2e8cf},
-    {0x7244a8d0,0x16c0,fvs_7244a8d0},
-    {0xb03f2dd0,0x0eb3,fvs_b03f2dd0},
-    {0x8c957fd1,0x0e77,fvs_8c957fd1},
-    {0xe0f25222,0x0d25,fvs_e0f25222},
-    {0x1751f4d5,0x0c75,fvs_1751f4d5},
-    {0x87c121d5,0x102c,fvs_87c121d5},
-    {0xd6e0bbd4,0x0ebb,fvs_d6e0bbd4},
-    {0x84e079ce,0x0eb3,fvs_84e079ce},
-    {0xd84ececf,0x0d24,fvs_d84ececf},
+    {0x988e56d5,0x0d9c,fvs_988e56d5},
+    {0x9e8a1a84,0x0d25,fvs_9e8a1a84},
+    {0x9f46fc1c,0x0ed4,fvs_9f46fc1c},
     {0x9f62e5dd,0x0886,fvs_9f62e5dd},
-    {0x95f09cdf,0x0d9c,fvs_95f09cdf},
-    {0x744ca4d0,0x1488,fvs_744ca4d0},
-    {0x3747f5e3,0x0d84,fvs_3747f5e3},
-    {0x8a34a0e4,0x16c0,fvs_8a34a0e4},
-    {0x696c5fe9,0x0ef8,fvs_696c5fe9},
-    {0xc3151226,0x0ed4,fvs_c3151226},
+    {0xa1a5b6cd,0x16c0,fvs_a1a5b6cd},
+    {0xa4f666fc,0x0e63,fvs_a4f666fc},
+    {0xa68da568,0x102c,fvs_a68da568},
+    {0xa72297ff,0x16c0,fvs_a72297ff},
+    {0xad11d38d,0x0d9c,fvs_ad11d38d},
+    {0xad60cd6a,0x0d25,fvs_ad60cd6a},
+    {0xaee2590e,0x0c05,fvs_aee2590e},
+    {0xaf2e687e,0x0ef8,fvs_af2e687e},
+    {0xb00da327,0x0ef8,fvs_b00da327},
+    {0xb03f2dd0,0x0eb3,fvs_b03f2dd0},
+    {0xb352b1f1,0x0ef8,fvs_b352b1f1},
+    {0xb370dc94,0x0d24,fvs_b370dc94},
+    {0xb62ad8df,0x0fc6,fvs_b62ad8df},
+    {0xb6b3868b,0x0ef8,fvs_b6b3868b},
+    {0xb6f8f21b,0x0eb3,fvs_b6f8f21b},
+    {0xb720b682,0x0c05,fvs_b720b682},
+    {0xb7946790,0x0eb3,fvs_b7946790},
+    {0xbe82e3b1,0x0e63,fvs_be82e3b1},
     {0xbec759ec,0x0ef8,fvs_bec759ec},
-    {0x782ee3ee,0x0c75,fvs_782ee3ee},
-    {0x7fc2bbef,0x1081,fvs_7fc2bbef},
+    {0xbf3afb7c,0x1488,fvs_bf3afb7c},
     {0xc04a00f0,0x0ed4,fvs_c04a00f0},
-    {0xb352b1f1,0x0ef8,fvs_b352b1f1},
-    {0x17e106f5,0x0ed4,fvs_17e106f5},
+    {0xc2ea917f,0x102c,fvs_c2ea917f},
+    {0xc3151226,0x0ed4,fvs_c3151226},
+    {0xc4c30a29,0x0ef8,fvs_c4c30a29},
+    {0xc55efa16,0x0ddb,fvs_c55efa16},
+    {0xc77c8bad,0x16c0,fvs_c77c8bad},
+    {0xcac30a97,0x0eb3,fvs_cac30a97},
     {0xcada6a40,0x0d25,fvs_cada6a40},
-    {0x59d5bef9,0x16c0,fvs_59d5bef9},
-    {0xaf2e687e,0x0ef8,fvs_af2e687e},
-    {0xa4f666fc,0x0e63,fvs_a4f666fc},
-    {0x1c08a6ff,0x0c75,fvs_1c08a6ff},
+    {0xcb5df64f,0x0eb3,fvs_cb5df64f},
+    {0xcbaf9f1c,0x0eb3,fvs_cbaf9f1c},
+    {0xcd089432,0x0d24,fvs_cd089432},
+    {0xd1bf11df,0x0d9c,fvs_d1bf11df},
+    {0xd6e0bbd4,0x0ebb,fvs_d6e0bbd4},
+    {0xd73c3039,0x0dc8,fvs_d73c3039},
+    {0xd7913109,0x0eb8,fvs_d7913109},
+    {0xd8220d13,0x0c05,fvs_d8220d13},
+    {0xd84ececf,0x0d24,fvs_d84ececf},
+    {0xdddcadec,0x0d84,fvs_dddcadec},
+    {0xe0f25222,0x0d25,fvs_e0f25222},
+    {0xe3a83899,0x0eb8,fvs_e3a83899},
+    {0xe6f41e4a,0x0ed4,fvs_e6f41e4a},
+    {0xf13ee569,0x0eb3,fvs_f13ee569},
+    {0xf20a3571,0x0c05,fvs_f20a3571},
+    {0xf234b061,0x0d24,fvs_f234b061},
+    {0xf2781a42,0x102c,fvs_f2781a42},
+    {0xf337612f,0x0ebb,fvs_f337612f},
+    {0xf42a8ff1,0x0ef8,fvs_f42a8ff1},
+    {0xf675b121,0x16c0,fvs_f675b121},
 };
 
 #endif/*_FSB_VORBIS_DATA_H_ */
@@ -3776,6 +3776,7 @@ static const uint8_t wvc_standard_0255[] = {
     0x94,0x62,0x8b,0xb1,0xf7,0x9e,0x42,0x0a,0x39,0xb6,0x18,0x63,0xef,0x3d,0xc7,0x94,0x5a,0x6c,0xad,0xc6,0xde,0x7b,0x8d,0x29,0xc5,0x56,0x63,0x8c,0xbd,0xf7,0xde,0x63,
     0x8c,0xad,0xc6,0x5a,0x7b,0xef,0xbd,0xc7,0xd8,0x5a,0xad,0x39,0x16,0x00,0x30,0x1b,0x1c,0x00,0x20,0x12,0x6c,0x58,0x1d,0xe1,0xa4,0x68,0x2c,0x30,
 };
+/* ids are dense, so lists are indexed by id */
 static const wvc_info wvc_list_standard[] = {
     {0x0000,0x004e,wvc_standard_0000},
     {0x0001,0x0035,wvc_standard_0001},
@@ -8143,6 +8144,7 @@ static const uint8_t wvc_aotuv603_0255[] = {
     0x12,0x05,0x28,0x52,0x56,0x5b,0xed,0xc1,0x38,0x02,0x51,0x26,0xad,0xe6,0xd0,0x20,0xca,0x24,0xe6,0xa2,0x2b,0x86,0x94,0xa3,0xd8,0x53,0xa4,0x10,0x52,0x10,0x73,0x8b,
     0x98,0x42,0x0a,0x5a,0x6d,0x15,0x73,0x8a,0x41,0x8b,0xb5,0x73,0x0c,0x21,0x27,0xad,0x87,0xd0,0x29,0xc5,0x20,0x04,
 };
+/* ids are dense, so lists are indexed by id */
 static const wvc_info wvc_list_aotuv603[] = {
     {0x0000,0x0008,wvc_aotuv603_0000},
     {0x0001,0x000d,wvc_aotuv603_0001},
@@ -1,4 +1,3 @@
-#include <math.h>
 #include "coding.h"
 #include "vorbis_custom_decoder.h"
 
@@ -6,8 +5,14 @@
 #include <vorbis/codec.h>
 
 #define VORBIS_DEFAULT_BUFFER_SIZE 0x8000 /* should be at least the size of the setup header, ~0x2000 */
+#define VORBIS_SEEK_INTERVAL 4096 /* min samples between synthesized seek points */
+#define VORBIS_SINK_BUFFER_SAMPLES 4096 /* per channel, at least max blocksize/2 to pass a block at once */
 
-static void pcm_convert_float_to_16(vorbis_custom_codec_data * data, sample * outbuf, int samples_to_do, float ** pcm);
+static vorbis_custom_codec_data * init_headers(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_t type, vorbis_custom_config * config);
+static int decode_packet(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data);
+static void build_seek_table(VGMSTREAM *vgmstream, vorbis_custom_codec_data * data);
+static vorbis_custom_info * info_acquire(vorbis_custom_codec_data * data);
+static void info_release(vorbis_custom_info * info);
 
 /**
  * Inits a vorbis stream of some custom variety.
@@ -23,6 +28,53 @@ vorbis_custom_codec_data * init_vorbis_custom(STREAMFILE *streamFile, off_t star
     vorbis_custom_codec_data * data = NULL;
     int ok;
 
+    data = init_headers(streamFile, start_offset, type, config);
+    if (!data) goto fail;
+
+    /* init optional indexes (cached if possible, as they need to scan the whole stream) */
+    if (!vorbis_custom_cache_load(streamFile, start_offset, data)) {
+        switch(data->type) {
+            case VORBIS_WWISE:  ok = vorbis_custom_index_wwise(streamFile, data); break;
+            default: ok = 0; break;
+        }
+        if (ok)
+            vorbis_custom_cache_save(data);
+    }
+
+    /* init vorbis global and block state */
+    if (vorbis_synthesis_init(&data->vd,data->vi) != 0) goto fail;
+    if (vorbis_block_init(&data->vd,&data->vb) != 0) goto fail;
+
+
+    /* write output */
+    config->data_start_offset = data->config.data_start_offset;
+
+
+    return data;
+
+fail:
+    VGM_LOG("VORBIS: init fail at around 0x%"PRIx64"\n", (off64_t)start_offset);
+    free_vorbis_custom(data);
+    return NULL;
+}
+
+/* Inits only the headers (vi and header triad) without decoder state, for callers that just move packets
+ * around (remuxing). Must be freed with free_vorbis_custom. */
+vorbis_custom_codec_data * init_vorbis_custom_headers(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_t type, vorbis_custom_config * config) {
+    vorbis_custom_codec_data * data = init_headers(streamFile, start_offset, type, config);
+    if (!data) {
+        VGM_LOG("VORBIS: init headers fail at around 0x%"PRIx64"\n", (off64_t)start_offset);
+        return NULL;
+    }
+
+    config->data_start_offset = data->config.data_start_offset;
+    return data;
+}
+
+static vorbis_custom_codec_data * init_headers(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_t type, vorbis_custom_config * config) {
+    vorbis_custom_codec_data * data = NULL;
+    int ok;
+
     /* init stuff */
     data = calloc(1,sizeof(vorbis_custom_codec_data));
     if (!data) goto fail;
@@ -37,10 +89,8 @@ vorbis_custom_codec_data * init_vorbis_custom(STREAMFILE *streamFile, off_t star
 
 
     /* init vorbis stream state, using 3 fake Ogg setup packets (info, comments, setup/codebooks)
-     * libvorbis expects parsed Ogg pages, but we'll fake them with our raw data instead */
-    vorbis_info_init(&data->vi);
-    vorbis_comment_init(&data->vc);
-
+     * libvorbis expects parsed Ogg pages, but we'll fake them with our raw data instead
+     * (packets are passed to vorbis_custom_headerin, and parsed once all are found) */
     data->op.packet = data->buffer;
     data->op.b_o_s = 1; /* fake headers start */
 
@@ -54,39 +104,36 @@ vorbis_custom_codec_data * init_vorbis_custom(STREAMFILE *streamFile, off_t star
         default: goto fail;
     }
     if(!ok) goto fail;
+    if (!data->info) goto fail; /* missing headers */
 
     data->op.b_o_s = 0; /* end of fake headers */
 
-    /* init vorbis global and block state */
-    if (vorbis_synthesis_init(&data->vd,&data->vi) != 0) goto fail;
-    if (vorbis_block_init(&data->vd,&data->vb) != 0) goto fail;
-
-
-    /* write output */
-    config->data_start_offset = data->config.data_start_offset;
-
-
     return data;
 
 fail:
-    VGM_LOG("VORBIS: init fail at around 0x%"PRIx64"\n", (off64_t)start_offset);
     free_vorbis_custom(data);
     return NULL;
 }
 
 /* Decodes Vorbis packets into a libvorbis sample buffer, and copies them to outbuf */
 void decode_vorbis_custom(VGMSTREAM * vgmstream, sample * outbuf, int32_t samples_to_do, int channels) {
+    decode_vorbis_custom_fmt(vgmstream, outbuf, SAMPLE_FMT_S16, samples_to_do, channels);
+}
+
+/* Same as decode_vorbis_custom, but copying libvorbis samples to outbuf in any format */
+void decode_vorbis_custom_fmt(VGMSTREAM * vgmstream, void * outbuf, sample_fmt_t fmt, int32_t samples_to_do, int channels) {
     VGMSTREAMCHANNEL *stream = &vgmstream->ch[0];
     vorbis_custom_codec_data * data = vgmstream->codec_data;
     size_t stream_size =  get_streamfile_size(stream->streamfile);
     //data->op.packet = data->buffer;/* implicit from init */
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
     int samples_done = 0;
 
     while (samples_done < samples_to_do) {
 
         /* extra EOF check for edge cases */
         if (stream->offset >= stream_size) {
-            memset(outbuf + samples_done * channels, 0, (samples_to_do - samples_done) * sizeof(sample) * channels);
+            clear_sample_buffer(outbuf, fmt, channels, samples_done, samples_to_do - samples_done);
             break;
         }
 
@@ -109,10 +156,11 @@ void decode_vorbis_custom(VGMSTREAM * vgmstream, sample * outbuf, int32_t sample
                 data->samples_to_discard -= samples_to_get;
             }
             else {
-                /* get max samples and convert from Vorbis float pcm to 16bit pcm */
+                /* get max samples and convert from Vorbis float pcm to output pcm */
                 if (samples_to_get > samples_to_do - samples_done)
                     samples_to_get = samples_to_do - samples_done;
-                pcm_convert_float_to_16(data, outbuf + samples_done * channels, samples_to_get, pcm);
+                vorbis_custom_pcm_convert_fmt(get_sample_buffer_offset(outbuf, fmt, channels, samples_done, planar_buf),
+                        fmt, pcm, data->vi->channels, samples_to_get);
                 samples_done += samples_to_get;
             }
 
@@ -121,69 +169,305 @@ void decode_vorbis_custom(VGMSTREAM * vgmstream, sample * outbuf, int32_t sample
             vorbis_synthesis_read(&data->vd, samples_to_get);
         }
         else { /* read more data */
-            int ok, rc;
+            int ok;
 
             /* not actually needed, but feels nicer */
             data->op.granulepos += samples_to_do; /* can be changed next if desired */
-            data->op.packetno++;
-
-            /* read/transform data into the ogg_packet buffer and advance offsets */
-            switch(data->type) {
-                case VORBIS_FSB:    ok = vorbis_custom_parse_packet_fsb(stream, data); break;
-                case VORBIS_WWISE:  ok = vorbis_custom_parse_packet_wwise(stream, data); break;
-                case VORBIS_OGL:    ok = vorbis_custom_parse_packet_ogl(stream, data); break;
-                case VORBIS_SK:     ok = vorbis_custom_parse_packet_sk(stream, data); break;
-                case VORBIS_VID1:   ok = vorbis_custom_parse_packet_vid1(stream, data); break;
-                default: goto decode_fail;
-            }
-            if(!ok) {
-                goto decode_fail;
+
+            ok = decode_packet(stream, data);
+            if (ok < 0) goto decode_fail;
+            if (ok == 0) continue;
+        }
+    }
+
+    return;
+
+decode_fail:
+    /* on error just put some 0 samples */
+    VGM_LOG("VORBIS: decode fail at %"PRIx64", missing %i samples\n", (off64_t)stream->offset, (samples_to_do - samples_done));
+    clear_sample_buffer(outbuf, fmt, channels, samples_done, samples_to_do - samples_done);
+}
+
+/* Decodes from the current position until the end of data (or max_samples) straight to a sink,
+ * a whole libvorbis block at a time, for callers that just want all samples (like transcoding).
+ * Returns samples done (less than expected on errors or if the sink stops). */
+int32_t decode_vorbis_custom_to_end(VGMSTREAM * vgmstream, sample_fmt_t fmt, int32_t max_samples, vgmstream_sink_t sink, void * user_data) {
+    VGMSTREAMCHANNEL *stream = &vgmstream->ch[0];
+    vorbis_custom_codec_data * data = vgmstream->codec_data;
+    size_t stream_size =  get_streamfile_size(stream->streamfile);
+    int channels = vgmstream->channels;
+    uint8_t * buf = NULL;
+    int32_t samples_done = 0;
+
+    /* converted samples for the sink (float planar is passed as-is) */
+    if (fmt != SAMPLE_FMT_FLOATP) {
+        buf = malloc(VORBIS_SINK_BUFFER_SAMPLES * channels * sizeof(int32_t));
+        if (!buf) goto decode_fail;
+    }
+
+    while (samples_done < max_samples) {
+
+        if (data->samples_full) {  /* read more samples */
+            int samples_to_get;
+            float **pcm;
+
+            samples_to_get = vorbis_synthesis_pcmout(&data->vd, &pcm);
+            if (!samples_to_get) {
+                data->samples_full = 0; /* request more if empty*/
+                continue;
             }
 
+            if (data->samples_to_discard) {
+                if (samples_to_get > data->samples_to_discard)
+                    samples_to_get = data->samples_to_discard;
+                data->samples_to_discard -= samples_to_get;
+            }
+            else {
+                if (samples_to_get > max_samples - samples_done)
+                    samples_to_get = max_samples - samples_done;
+                samples_done += samples_to_get;
 
-            /* parse the fake ogg packet into a logical vorbis block */
-            rc = vorbis_synthesis(&data->vb,&data->op);
-            if (rc == OV_ENOTAUDIO) {
-                VGM_LOG("Vorbis: not an audio packet (size=0x%x) @ %"PRIx64"\n",(size_t)data->op.bytes,(off64_t)stream->offset);
-                //VGM_LOGB(data->op.packet, (size_t)data->op.bytes,0);
-                continue; /* rarely happens, seems ok? */
-            } else if (rc != 0) goto decode_fail;
+                if (!vorbis_custom_pcm_sink(pcm, channels, samples_to_get, fmt, buf, VORBIS_SINK_BUFFER_SAMPLES, sink, user_data)) {
+                    vorbis_synthesis_read(&data->vd, samples_to_get);
+                    break;
+                }
+            }
 
-            /* finally decode the logical block into samples */
-            rc = vorbis_synthesis_blockin(&data->vd,&data->vb);
-            if (rc != 0) goto decode_fail; /* ? */
+            vorbis_synthesis_read(&data->vd, samples_to_get);
+        }
+        else { /* read more data */
+            int ok;
 
+            if (stream->offset >= stream_size)
+                break;
 
-            data->samples_full = 1;
+            ok = decode_packet(stream, data);
+            if (ok < 0) goto decode_fail;
         }
     }
 
-    return;
+    free(buf);
+    return samples_done;
 
 decode_fail:
-    /* on error just put some 0 samples */
-    VGM_LOG("VORBIS: decode fail at %"PRIx64", missing %i samples\n", (off64_t)stream->offset, (samples_to_do - samples_done));
-    memset(outbuf + samples_done * channels, 0, (samples_to_do - samples_done) * channels * sizeof(sample));
+    VGM_LOG("VORBIS: decode to end fail at %"PRIx64"\n", (off64_t)stream->offset);
+    free(buf);
+    return samples_done;
 }
 
-/* converts from internal Vorbis format to standard PCM (mostly from Xiph's decoder_example.c) */
-static void pcm_convert_float_to_16(vorbis_custom_codec_data * data, sample * outbuf, int samples_to_do, float ** pcm) {
-    int i,j;
+/* Reads the next packet into the ogg_packet buffer and decodes it into libvorbis buffers.
+ * Returns 1 if samples are available, 0 if the packet must be skipped, or -1 on error. */
+static int decode_packet(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data) {
+    int ok, rc;
+
+    data->op.packetno++;
+
+    /* read/transform data into the ogg_packet buffer and advance offsets */
+    switch(data->type) {
+        case VORBIS_FSB:    ok = vorbis_custom_parse_packet_fsb(stream, data); break;
+        case VORBIS_WWISE:  ok = vorbis_custom_parse_packet_wwise(stream, data); break;
+        case VORBIS_OGL:    ok = vorbis_custom_parse_packet_ogl(stream, data); break;
+        case VORBIS_SK:     ok = vorbis_custom_parse_packet_sk(stream, data); break;
+        case VORBIS_VID1:   ok = vorbis_custom_parse_packet_vid1(stream, data); break;
+        default: return -1;
+    }
+    if(!ok) {
+        return -1;
+    }
+
 
-    /* convert float PCM (multichannel float array, with pcm[0]=ch0, pcm[1]=ch1, pcm[2]=ch0, etc)
-     * to 16 bit signed PCM ints (host order) and interleave + fix clipping */
-    for (i = 0; i < data->vi.channels; i++) {
-        sample *ptr = outbuf + i;
-        float *mono = pcm[i];
-        for (j = 0; j < samples_to_do; j++) {
-            int val = (int)floor(mono[j] * 32767.f + .5f);
-            if (val > 32767) val = 32767;
-            if (val < -32768) val = -32768;
+    /* parse the fake ogg packet into a logical vorbis block */
+    rc = vorbis_synthesis(&data->vb,&data->op);
+    if (rc == OV_ENOTAUDIO) {
+        VGM_LOG("Vorbis: not an audio packet (size=0x%x) @ %"PRIx64"\n",(size_t)data->op.bytes,(off64_t)stream->offset);
+        //VGM_LOGB(data->op.packet, (size_t)data->op.bytes,0);
+        return 0; /* rarely happens, seems ok? */
+    } else if (rc != 0) return -1;
 
-            *ptr = val;
-            ptr += data->vi.channels;
+    /* finally decode the logical block into samples */
+    rc = vorbis_synthesis_blockin(&data->vd,&data->vb);
+    if (rc != 0) return -1; /* ? */
+
+
+    data->samples_full = 1;
+    return 1;
+}
+
+/* ********************************************** */
+
+/* Streams often share the same headers (ex. games reuse setups/codebooks), and parsed setups are big and slow
+ * to make, so parsed vorbis_info/comments are kept in a process-wide list. Entries are read-only once made,
+ * and freed when no stream uses them. */
+struct vorbis_custom_info {
+    uint64_t hash;
+    uint8_t * header_data;      /* headers used to make this entry */
+    size_t header_sizes[3];
+    int refs;
+
+    vorbis_info vi;
+    vorbis_comment vc;
+
+    vorbis_custom_info * next;
+};
+
+static vorbis_custom_info * info_list = NULL;
+static vgm_mutex_t info_mutex = VGM_MUTEX_INIT;
+
+/* Collects a header packet from data->op (instead of vorbis_synthesis_headerin), and after the
+ * third gets a shared vi/vc. Returns 0 on success like vorbis_synthesis_headerin. */
+int vorbis_custom_headerin(vorbis_custom_codec_data *data) {
+    uint8_t * header_data_new;
+    size_t header_data_size = 0;
+    int i;
+
+    if (data->header_count >= 3 || data->op.bytes <= 0) goto fail;
+
+    for (i = 0; i < data->header_count; i++) {
+        header_data_size += data->header_sizes[i];
+    }
+
+    header_data_new = realloc(data->header_data, header_data_size + data->op.bytes);
+    if (!header_data_new) goto fail;
+    data->header_data = header_data_new;
+
+    memcpy(data->header_data + header_data_size, data->op.packet, data->op.bytes);
+    data->header_sizes[data->header_count] = data->op.bytes;
+    data->header_count++;
+
+    if (data->header_count == 3) {
+        data->info = info_acquire(data);
+        if (!data->info) goto fail;
+
+        data->vi = &data->info->vi;
+        data->vc = &data->info->vc;
+    }
+
+    return 0;
+fail:
+    return OV_EBADHEADER;
+}
+
+/* Points data->op to a packet of bytes at offset, without copying when the streamfile allows it (the pointer
+ * is valid until the next streamfile call, so it must be consumed before reading anything else).
+ * Parsers that transform packets use data->buffer instead. Returns 1 if all bytes were read. */
+int vorbis_custom_read_packet(STREAMFILE *streamFile, off_t offset, size_t bytes, vorbis_custom_codec_data *data) {
+    const uint8_t * ptr;
+
+    if (bytes > data->buffer_size)
+        return 0;
+
+    ptr = peek_streamfile(data->buffer, offset, bytes, streamFile);
+    if (!ptr)
+        return 0;
+
+    data->op.packet = (uint8_t *)ptr; /* only read by libvorbis */
+    data->op.bytes = bytes;
+    return 1;
+}
+
+static int info_match(vorbis_custom_info * info, uint64_t hash, vorbis_custom_codec_data * data, size_t header_data_size) {
+    return info->hash == hash &&
+            info->header_sizes[0] == data->header_sizes[0] &&
+            info->header_sizes[1] == data->header_sizes[1] &&
+            info->header_sizes[2] == data->header_sizes[2] &&
+            memcmp(info->header_data, data->header_data, header_data_size) == 0;
+}
+
+static vorbis_custom_info * info_acquire(vorbis_custom_codec_data * data) {
+    vorbis_custom_info * info = NULL;
+    size_t header_data_size = data->header_sizes[0] + data->header_sizes[1] + data->header_sizes[2];
+    uint64_t hash = hash_fnv1a(VGM_HASH_INIT, data->header_data, header_data_size);
+    int i;
+
+    vgm_mutex_lock(&info_mutex);
+
+    for (info = info_list; info != NULL; info = info->next) {
+        if (info_match(info, hash, data, header_data_size)) {
+            info->refs++;
+            vgm_mutex_unlock(&info_mutex);
+            return info;
+        }
+    }
+
+    /* not found: parse headers (inside the lock, since libvorbis finishes setup on first use) */
+    info = calloc(1, sizeof(vorbis_custom_info));
+    if (!info) goto fail;
+
+    vorbis_info_init(&info->vi);
+    vorbis_comment_init(&info->vc);
+
+    {
+        ogg_packet op = {0};
+        size_t header_offset = 0;
+
+        op.b_o_s = 1; /* fake headers start */
+        for (i = 0; i < 3; i++) {
+            op.packet = data->header_data + header_offset;
+            op.bytes = data->header_sizes[i];
+            if (vorbis_synthesis_headerin(&info->vi, &info->vc, &op) != 0) goto fail;
+            header_offset += data->header_sizes[i];
         }
     }
+
+    /* libvorbis expands codebooks into vi on the first vorbis_synthesis_init, so do it now
+     * to make sure the shared vi isn't modified later */
+    {
+        vorbis_dsp_state vd = {0};
+        if (vorbis_synthesis_init(&vd, &info->vi) != 0) goto fail;
+        vorbis_dsp_clear(&vd);
+    }
+
+    info->header_data = malloc(header_data_size);
+    if (!info->header_data) goto fail;
+    memcpy(info->header_data, data->header_data, header_data_size);
+    memcpy(info->header_sizes, data->header_sizes, sizeof(info->header_sizes));
+    info->hash = hash;
+    info->refs = 1;
+
+    info->next = info_list;
+    info_list = info;
+
+    vgm_mutex_unlock(&info_mutex);
+    return info;
+
+fail:
+    vgm_mutex_unlock(&info_mutex);
+    if (info) {
+        vorbis_info_clear(&info->vi);
+        vorbis_comment_clear(&info->vc);
+        free(info->header_data);
+        free(info);
+    }
+    return NULL;
+}
+
+static void info_release(vorbis_custom_info * info) {
+    vorbis_custom_info ** prev;
+
+    if (!info)
+        return;
+
+    vgm_mutex_lock(&info_mutex);
+
+    info->refs--;
+    if (info->refs > 0) {
+        vgm_mutex_unlock(&info_mutex);
+        return;
+    }
+
+    for (prev = &info_list; *prev != NULL; prev = &(*prev)->next) {
+        if (*prev == info) {
+            *prev = info->next;
+            break;
+        }
+    }
+
+    vgm_mutex_unlock(&info_mutex);
+
+    vorbis_info_clear(&info->vi);
+    vorbis_comment_clear(&info->vc);
+    free(info->header_data);
+    free(info);
 }
 
 /* ********************************************** */
@@ -192,11 +476,14 @@ void free_vorbis_custom(vorbis_custom_codec_data * data) {
     if (!data)
         return;
 
-    /* internal decoder cleanp */
-    vorbis_info_clear(&data->vi);
-    vorbis_comment_clear(&data->vc);
+    /* internal decoder cleanp (vi is used until the end) */
+    vorbis_block_clear(&data->vb);
     vorbis_dsp_clear(&data->vd);
+    info_release(data->info);
 
+    free(data->header_data);
+    free(data->seek_table);
+    free(data->packets);
     free(data->buffer);
     free(data);
 }
@@ -213,14 +500,100 @@ void reset_vorbis_custom(VGMSTREAM *vgmstream) {
 
 void seek_vorbis_custom(VGMSTREAM *vgmstream, int32_t num_sample) {
     vorbis_custom_codec_data *data = vgmstream->codec_data;
+    int32_t seek_sample = 0;
+    off_t seek_offset = 0;
     if (!data) return;
 
     /* Seeking is provided by the Ogg layer, so with custom vorbis we'd need seek tables instead.
-     * To avoid having to parse different formats we'll just discard until the expected sample */
+     * Jump to the closest previous seek point if the format has them (or make them), and discard until the expected sample */
+    if (!data->seek_count && !data->seek_table_scanned && num_sample > 0) {
+        build_seek_table(vgmstream, data);
+        vorbis_custom_cache_save(data);
+    }
+
+    if (data->seek_count) {
+        int lo = 0, hi = data->seek_count - 1;
+
+        while (lo <= hi) {
+            int mid = lo + (hi - lo) / 2;
+
+            if (data->seek_table[mid].sample <= num_sample) {
+                seek_sample = data->seek_table[mid].sample;
+                seek_offset = data->seek_table[mid].offset;
+                lo = mid + 1;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+    }
+
     vorbis_synthesis_restart(&data->vd);
-    data->samples_to_discard = num_sample;
-    if (vgmstream->loop_ch)
-        vgmstream->loop_ch[0].offset = vgmstream->loop_ch[0].channel_start_offset;
+    data->samples_to_discard = num_sample - seek_sample;
+    if (vgmstream->loop_ch) {
+        vgmstream->loop_ch[0].offset = seek_offset ?
+                seek_offset :
+                vgmstream->loop_ch[0].channel_start_offset;
+    }
+}
+
+/* Makes seek points for formats without seek tables, by reading packet headers once (no decoding).
+ * When restarting at packet N, first output sample is the sum of samples of packets 1..N
+ * (packet 0 only primes the decoder), and each packet's samples are prev_blocksize/4 + blocksize/4. */
+static void build_seek_table(VGMSTREAM *vgmstream, vorbis_custom_codec_data * data) {
+    VGMSTREAMCHANNEL *stream = &vgmstream->ch[0];
+    vorbis_custom_seek * seek_table = NULL;
+    int seek_count = 0, seek_max = 0;
+    off_t offset = stream->channel_start_offset;
+    size_t stream_size = get_streamfile_size(stream->streamfile);
+    int32_t sample = 0, last_sample = 0;
+    int packet = 0, prev_blocksize = 0;
+
+    data->seek_table_scanned = 1; /* don't retry if it fails */
+
+    while (offset < stream_size && sample < vgmstream->num_samples) {
+        size_t packet_size = 0;
+        int ok, blocksize = 0;
+
+        switch(data->type) {
+            case VORBIS_FSB:    ok = vorbis_custom_packet_info_fsb(stream->streamfile, offset, data, &packet_size, &blocksize); break;
+            case VORBIS_WWISE:  ok = vorbis_custom_packet_info_wwise(stream->streamfile, offset, data, &packet_size, &blocksize); break;
+            case VORBIS_OGL:    ok = vorbis_custom_packet_info_ogl(stream->streamfile, offset, data, &packet_size, &blocksize); break;
+            default: goto fail;
+        }
+        if (!ok || !packet_size) break; /* end or bad packet, keep what we have */
+
+        if (packet > 0)
+            sample += prev_blocksize / 4 + blocksize / 4;
+
+        if (packet == 0 || sample - last_sample >= VORBIS_SEEK_INTERVAL) {
+            if (seek_count == seek_max) {
+                vorbis_custom_seek * seek_table_new;
+
+                seek_max = seek_max ? seek_max * 2 : 0x100;
+                seek_table_new = realloc(seek_table, seek_max * sizeof(vorbis_custom_seek));
+                if (!seek_table_new) goto fail;
+                seek_table = seek_table_new;
+            }
+
+            seek_table[seek_count].sample = sample;
+            seek_table[seek_count].offset = offset;
+            seek_count++;
+            last_sample = sample;
+        }
+
+        prev_blocksize = blocksize;
+        offset += packet_size;
+        packet++;
+    }
+
+    free(data->seek_table);
+    data->seek_table = seek_table;
+    data->seek_count = seek_count;
+    return;
+fail:
+    VGM_LOG("VORBIS: seek table build fail at %"PRIx64"\n", (off64_t)offset);
+    free(seek_table);
 }
 
 #endif
@@ -6,6 +6,9 @@
 
 /* used by vorbis_custom_decoder.c, but scattered in other .c files */
 #ifdef VGM_USE_VORBIS
+int vorbis_custom_headerin(vorbis_custom_codec_data *data);
+int vorbis_custom_read_packet(STREAMFILE *streamFile, off_t offset, size_t bytes, vorbis_custom_codec_data *data);
+
 int vorbis_custom_setup_init_fsb(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data);
 int vorbis_custom_setup_init_wwise(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data);
 int vorbis_custom_setup_init_ogl(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data);
@@ -17,6 +20,22 @@ int vorbis_custom_parse_packet_wwise(VGMSTREAMCHANNEL *stream, vorbis_custom_cod
 int vorbis_custom_parse_packet_ogl(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data *data);
 int vorbis_custom_parse_packet_sk(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data *data);
 int vorbis_custom_parse_packet_vid1(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data *data);
+
+int vorbis_custom_index_wwise(STREAMFILE *streamFile, vorbis_custom_codec_data *data);
+
+typedef enum { VORBIS_LIBRARY_WVC, VORBIS_LIBRARY_FVS, VORBIS_LIBRARY_RAW } vorbis_custom_library_t;
+const uint8_t * vorbis_custom_library_find(STREAMFILE *streamFile, const char * filename, vorbis_custom_library_t type, uint32_t id, size_t * size);
+
+void vorbis_custom_pcm_convert(sample * outbuf, float ** pcm, int channels, int samples_to_do);
+void vorbis_custom_pcm_convert_fmt(void * outbuf, sample_fmt_t fmt, float ** pcm, int channels, int samples_to_do);
+int vorbis_custom_pcm_sink(float ** pcm, int channels, int samples, sample_fmt_t fmt, void * buf, int buf_samples, vgmstream_sink_t sink, void * user_data);
+
+int vorbis_custom_cache_load(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data);
+int vorbis_custom_cache_save(vorbis_custom_codec_data *data);
+
+int vorbis_custom_packet_info_fsb(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize);
+int vorbis_custom_packet_info_wwise(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize);
+int vorbis_custom_packet_info_ogl(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize);
 #endif/* VGM_USE_VORBIS */
 
 #endif/*_VORBIS_CUSTOM_DECODER_H_ */
@@ -0,0 +1,276 @@
+#include <sys/stat.h>
+#include "vorbis_custom_decoder.h"
+
+#ifdef VGM_USE_VORBIS
+
+/* Process-wide cache of external codebook/setup libraries (.wvc, .fvs), since a single setup may need
+ * dozens of lookups and many streams share the same dir. Each library is loaded once and its offset
+ * table decoded into a sorted list. Libraries aren't freed, so returned pointers stay valid.
+ * Missing libraries are remembered too (as entries without data), and only probed again once their
+ * dir changes, so lookups outside the precompiled lists don't retry opening the file every time. */
+
+typedef struct {
+    uint32_t id;
+    uint32_t offset;
+    uint32_t size;
+} library_entry;
+
+typedef struct library_info {
+    char * path;                /* full path of the library */
+    vorbis_custom_library_t type;
+
+    uint8_t * data;             /* whole file */
+    size_t data_size;
+    library_entry * entries;    /* sorted by id */
+    int entry_count;            /* 0 if missing */
+    int64_t dir_mtime;          /* when missing, dir state at the time */
+
+    struct library_info * next;
+} library_info;
+
+static library_info * library_list = NULL;
+static vgm_mutex_t library_mutex = VGM_MUTEX_INIT;
+
+
+static int compare_entries(const void * a, const void * b) {
+    const library_entry * ea = a;
+    const library_entry * eb = b;
+    return (ea->id > eb->id) - (ea->id < eb->id);
+}
+
+/* decodes the library's offset table */
+static int parse_library(library_info * lib) {
+    int i, count;
+
+    switch(lib->type) {
+        case VORBIS_LIBRARY_WVC: { /* codebooks + offset table at the end (id = position) */
+            uint32_t table_start;
+
+            if (lib->data_size < 0x04) goto fail;
+            table_start = (uint32_t)get_32bitLE(lib->data + lib->data_size - 0x04); /* last offset */
+            if (table_start > lib->data_size - 0x04) goto fail;
+            count = ((lib->data_size - table_start) / 0x04) - 1;
+            if (count <= 0) goto fail;
+
+            lib->entries = malloc(count * sizeof(library_entry));
+            if (!lib->entries) goto fail;
+
+            for (i = 0; i < count; i++) {
+                uint32_t offset = (uint32_t)get_32bitLE(lib->data + table_start + i*0x04);
+                uint32_t next   = (uint32_t)get_32bitLE(lib->data + table_start + i*0x04 + 0x04);
+                if (offset > next || next > lib->data_size) goto fail;
+
+                lib->entries[i].id = i;
+                lib->entries[i].offset = offset;
+                lib->entries[i].size = next - offset;
+            }
+            break;
+        }
+
+        case VORBIS_LIBRARY_FVS: { /* "VFVS" mini-header (format by bnnm) + entries (id, offset, size, reserved) */
+            if (lib->data_size < 0x20) goto fail;
+            if (get_32bitBE(lib->data + 0x00) != 0x56465653) goto fail; /* "VFVS" */
+            count = get_32bitLE(lib->data + 0x08); /* 0x04=v0, 0x0c-0x20: reserved */
+            if (count <= 0 || 0x20 + count*0x10 > lib->data_size) goto fail;
+
+            lib->entries = malloc(count * sizeof(library_entry));
+            if (!lib->entries) goto fail;
+
+            for (i = 0; i < count; i++) {
+                uint8_t * entry = lib->data + 0x20 + i*0x10;
+
+                lib->entries[i].id     = (uint32_t)get_32bitLE(entry + 0x00);
+                lib->entries[i].offset = (uint32_t)get_32bitLE(entry + 0x04);
+                lib->entries[i].size   = (uint32_t)get_32bitLE(entry + 0x08);
+                if (lib->entries[i].offset > lib->data_size || lib->entries[i].size > lib->data_size - lib->entries[i].offset) goto fail;
+            }
+
+            qsort(lib->entries, count, sizeof(library_entry), compare_entries);
+            break;
+        }
+
+        case VORBIS_LIBRARY_RAW: /* whole file */
+            count = 1;
+            lib->entries = malloc(count * sizeof(library_entry));
+            if (!lib->entries) goto fail;
+
+            lib->entries[0].id = 0;
+            lib->entries[0].offset = 0;
+            lib->entries[0].size = lib->data_size;
+            break;
+
+        default:
+            goto fail;
+    }
+
+    lib->entry_count = count;
+    return 1;
+fail:
+    free(lib->entries);
+    lib->entries = NULL;
+    return 0;
+}
+
+static library_info * load_library(STREAMFILE *streamFile, const char * path, vorbis_custom_library_t type) {
+    STREAMFILE * streamFileLib = NULL;
+    library_info * lib = NULL;
+
+    streamFileLib = streamFile->open(streamFile, path, STREAMFILE_DEFAULT_BUFFER_SIZE);
+    if (!streamFileLib) goto fail;
+
+    lib = calloc(1, sizeof(library_info));
+    if (!lib) goto fail;
+
+    lib->type = type;
+    lib->path = strdup(path);
+    if (!lib->path) goto fail;
+
+    lib->data_size = get_streamfile_size(streamFileLib);
+    if (lib->data_size == 0 || lib->data_size > 0x10000000) goto fail; /* arbitrary max */
+    lib->data = malloc(lib->data_size);
+    if (!lib->data) goto fail;
+    if (read_streamfile(lib->data, 0, lib->data_size, streamFileLib) != lib->data_size) goto fail;
+
+    if (!parse_library(lib)) goto fail;
+
+    close_streamfile(streamFileLib);
+    return lib;
+fail:
+    if (streamFileLib) close_streamfile(streamFileLib);
+    if (lib) {
+        free(lib->path);
+        free(lib->data);
+        free(lib);
+    }
+    return NULL;
+}
+
+/* modification time of a dir (changes when files are added), or -1 if unknown */
+static int64_t get_dir_mtime(const char * dirname) {
+    struct stat st;
+
+    if (stat(dirname[0] != '\0' ? dirname : ".", &st) != 0)
+        return -1;
+#if defined(__APPLE__)
+    return (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    return (int64_t)st.st_mtime * 1000000000;
+#endif
+}
+
+/* call with library_mutex held */
+static library_info * find_library(const char * path, vorbis_custom_library_t type) {
+    library_info * lib;
+
+    for (lib = library_list; lib != NULL; lib = lib->next) {
+        if (lib->type == type && strcmp(lib->path, path) == 0)
+            return lib;
+    }
+    return NULL;
+}
+
+/* Finds an entry by id in a library file located in streamFile's dir, and returns a pointer to its data. */
+const uint8_t * vorbis_custom_library_find(STREAMFILE *streamFile, const char * filename, vorbis_custom_library_t type, uint32_t id, size_t * size) {
+    char dirname[PATH_LIMIT];
+    char path[PATH_LIMIT];
+    library_info * lib, * new_lib = NULL;
+    int64_t dir_mtime = -1, missing_mtime = -1;
+    int missing = 0;
+    const uint8_t * found = NULL;
+
+    /* "(dir/)(filename)" */
+    {
+        char *dir;
+
+        streamFile->get_name(streamFile,dirname,sizeof(dirname));
+        dir = strrchr(dirname,DIR_SEPARATOR);
+        if (dir)
+            *(dir+1) = '\0';
+        else
+            dirname[0] = '\0';
+
+        snprintf(path,PATH_LIMIT,"%s%s", dirname, filename);
+    }
+
+    vgm_mutex_lock(&library_mutex);
+    lib = find_library(path, type);
+    if (lib && lib->entry_count == 0) { /* missing entries may be updated by other threads */
+        missing = 1;
+        missing_mtime = lib->dir_mtime;
+    }
+    vgm_mutex_unlock(&library_mutex);
+
+    /* missing before, ignore unless the dir changed since */
+    if (missing) {
+        dir_mtime = get_dir_mtime(dirname);
+        if (dir_mtime == missing_mtime)
+            return NULL;
+        lib = NULL;
+    }
+
+    /* not loaded yet: load without the lock (other threads keep using loaded libraries meanwhile) */
+    if (!lib) {
+        if (dir_mtime < 0)
+            dir_mtime = get_dir_mtime(dirname);
+
+        new_lib = load_library(streamFile, path, type);
+        if (!new_lib) {
+            new_lib = calloc(1, sizeof(library_info));
+            if (!new_lib) return NULL;
+            new_lib->type = type;
+            new_lib->path = strdup(path);
+            if (!new_lib->path) {
+                free(new_lib);
+                return NULL;
+            }
+        }
+        new_lib->dir_mtime = dir_mtime;
+    }
+
+    vgm_mutex_lock(&library_mutex);
+
+    if (new_lib) {
+        /* may be added by another thread meanwhile */
+        lib = find_library(path, type);
+        if (!lib) {
+            new_lib->next = library_list;
+            library_list = new_lib;
+            lib = new_lib;
+        }
+        else if (lib->entry_count == 0) {
+            /* update the missing entry (positive entries are never changed, as their data may be in use) */
+            lib->data = new_lib->data;
+            lib->data_size = new_lib->data_size;
+            lib->entries = new_lib->entries;
+            lib->entry_count = new_lib->entry_count;
+            lib->dir_mtime = new_lib->dir_mtime;
+            free(new_lib->path);
+            free(new_lib);
+        }
+        else {
+            free(new_lib->path);
+            free(new_lib->data);
+            free(new_lib->entries);
+            free(new_lib);
+        }
+    }
+
+    if (lib->entry_count) {
+        library_entry key, * entry;
+
+        key.id = id;
+        entry = bsearch(&key, lib->entries, lib->entry_count, sizeof(library_entry), compare_entries);
+        if (entry) {
+            *size = entry->size;
+            found = lib->data + entry->offset;
+        }
+    }
+
+    vgm_mutex_unlock(&library_mutex);
+
+    return found;
+}
+
+#endif
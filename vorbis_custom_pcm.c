@@ -0,0 +1,397 @@
+#include <math.h>
+#include "vorbis_custom_decoder.h"
+
+#ifdef VGM_USE_VORBIS
+
+/* Float to 16-bit PCM conversion + interleave for libvorbis output (pcm[0]=ch0, pcm[1]=ch1, etc), with
+ * SSE2/AVX2/NEON kernels picked on first use. All kernels must match convert_sample bit-exactly.
+ *
+ * Rounding is floor(x * 32767 + 0.5) in float precision, clamped. x*32767 is done as (x*32768 - x):
+ * x*32768 is exact so the result is the same, but it also can't change if the compiler fuses
+ * mul+add into FMA (which would round once instead of twice). NaN and huge values (undefined
+ * before) saturate like any other out of range value. */
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PCM_USE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define PCM_USE_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PCM_TARGET_AVX2
+#else
+#define PCM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PCM_USE_NEON
+#include <arm_neon.h>
+#endif
+
+#define PCM_BLOCK_FRAMES 64     /* frames converted per channel before interleaving */
+#define PCM_BLOCK_CHANNELS 8    /* max channels for the block interleaver (7.1), more use scalar */
+
+typedef struct {
+    const char * name;
+    void (*convert_mono)(sample * outbuf, const float * src, int samples);
+    void (*convert_stereo)(sample * outbuf, const float * left, const float * right, int samples);
+} pcm_kernels;
+
+
+/* ********************************************** */
+
+static inline sample convert_sample(float f) {
+    float val = (f * 32768.f - f) + .5f;
+
+    if (!(val >= -32768.f)) val = -32768.f; /* also NaN */
+    if (val > 32767.f) val = 32767.f;
+    return (sample)floor(val);
+}
+
+static void scalar_convert_mono(sample * outbuf, const float * src, int samples) {
+    int i;
+    for (i = 0; i < samples; i++) {
+        outbuf[i] = convert_sample(src[i]);
+    }
+}
+
+static void scalar_convert_stereo(sample * outbuf, const float * left, const float * right, int samples) {
+    int i;
+    for (i = 0; i < samples; i++) {
+        outbuf[i*2 + 0] = convert_sample(left[i]);
+        outbuf[i*2 + 1] = convert_sample(right[i]);
+    }
+}
+
+static const pcm_kernels scalar_kernels = { "scalar", scalar_convert_mono, scalar_convert_stereo };
+
+
+/* ********************************************** */
+
+#ifdef PCM_USE_SSE2
+static inline __m128i sse2_convert4(const float * src) {
+    const __m128 x = _mm_loadu_ps(src);
+    __m128 val;
+    __m128i trunc;
+
+    val = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(32768.f)), x), _mm_set1_ps(.5f));
+    val = _mm_min_ps(_mm_max_ps(val, _mm_set1_ps(-32768.f)), _mm_set1_ps(32767.f)); /* max returns 2nd arg on NaN */
+
+    /* no floor in SSE2: truncation rounds negatives up, so subtract 1 where the result went above */
+    trunc = _mm_cvttps_epi32(val);
+    return _mm_add_epi32(trunc, _mm_castps_si128(_mm_cmplt_ps(val, _mm_cvtepi32_ps(trunc))));
+}
+
+static inline __m128i sse2_convert8(const float * src) {
+    return _mm_packs_epi32(sse2_convert4(src + 0), sse2_convert4(src + 4));
+}
+
+static void sse2_convert_mono(sample * outbuf, const float * src, int samples) {
+    int i;
+    for (i = 0; i + 8 <= samples; i += 8) {
+        _mm_storeu_si128((__m128i*)(outbuf + i), sse2_convert8(src + i));
+    }
+    scalar_convert_mono(outbuf + i, src + i, samples - i);
+}
+
+static void sse2_convert_stereo(sample * outbuf, const float * left, const float * right, int samples) {
+    int i;
+    for (i = 0; i + 8 <= samples; i += 8) {
+        __m128i l = sse2_convert8(left + i);
+        __m128i r = sse2_convert8(right + i);
+        _mm_storeu_si128((__m128i*)(outbuf + i*2 + 0), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i*)(outbuf + i*2 + 8), _mm_unpackhi_epi16(l, r));
+    }
+    scalar_convert_stereo(outbuf + i*2, left + i, right + i, samples - i);
+}
+
+static const pcm_kernels sse2_kernels = { "sse2", sse2_convert_mono, sse2_convert_stereo };
+#endif
+
+#ifdef PCM_USE_AVX2
+PCM_TARGET_AVX2 static inline __m256i avx2_convert8(const float * src) {
+    const __m256 x = _mm256_loadu_ps(src);
+    __m256 val;
+
+    val = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(x, _mm256_set1_ps(32768.f)), x), _mm256_set1_ps(.5f));
+    val = _mm256_min_ps(_mm256_max_ps(val, _mm256_set1_ps(-32768.f)), _mm256_set1_ps(32767.f));
+    return _mm256_cvttps_epi32(_mm256_floor_ps(val));
+}
+
+PCM_TARGET_AVX2 static inline __m256i avx2_convert16(const float * src) {
+    /* packs works per 128b lane, so reorder 64b quarters from a0 b0 a1 b1 to a0 a1 b0 b1 */
+    __m256i packed = _mm256_packs_epi32(avx2_convert8(src + 0), avx2_convert8(src + 8));
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+PCM_TARGET_AVX2 static void avx2_convert_mono(sample * outbuf, const float * src, int samples) {
+    int i;
+    for (i = 0; i + 16 <= samples; i += 16) {
+        _mm256_storeu_si256((__m256i*)(outbuf + i), avx2_convert16(src + i));
+    }
+    scalar_convert_mono(outbuf + i, src + i, samples - i);
+}
+
+PCM_TARGET_AVX2 static void avx2_convert_stereo(sample * outbuf, const float * left, const float * right, int samples) {
+    int i;
+    for (i = 0; i + 16 <= samples; i += 16) {
+        __m256i l = avx2_convert16(left + i);
+        __m256i r = avx2_convert16(right + i);
+        __m256i lo = _mm256_unpacklo_epi16(l, r); /* frames 0..3 + 8..11 */
+        __m256i hi = _mm256_unpackhi_epi16(l, r); /* frames 4..7 + 12..15 */
+        _mm256_storeu_si256((__m256i*)(outbuf + i*2 + 0), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(outbuf + i*2 + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    scalar_convert_stereo(outbuf + i*2, left + i, right + i, samples - i);
+}
+
+static const pcm_kernels avx2_kernels = { "avx2", avx2_convert_mono, avx2_convert_stereo };
+
+static int cpu_has_avx2(void) {
+#ifdef _MSC_VER
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    if ((info[2] & 0x18000000) != 0x18000000) return 0; /* OSXSAVE + AVX */
+    if ((_xgetbv(0) & 0x06) != 0x06) return 0; /* OS saves XMM + YMM */
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef PCM_USE_NEON
+static inline int32x4_t neon_convert4(const float * src) {
+    const float32x4_t x = vld1q_f32(src);
+    float32x4_t val;
+
+    val = vaddq_f32(vsubq_f32(vmulq_f32(x, vdupq_n_f32(32768.f)), x), vdupq_n_f32(.5f));
+    val = vminq_f32(vmaxnmq_f32(val, vdupq_n_f32(-32768.f)), vdupq_n_f32(32767.f)); /* maxnm returns the number on NaN */
+    return vcvtq_s32_f32(vrndmq_f32(val));
+}
+
+static inline int16x8_t neon_convert8(const float * src) {
+    return vcombine_s16(vqmovn_s32(neon_convert4(src + 0)), vqmovn_s32(neon_convert4(src + 4)));
+}
+
+static void neon_convert_mono(sample * outbuf, const float * src, int samples) {
+    int i;
+    for (i = 0; i + 8 <= samples; i += 8) {
+        vst1q_s16(outbuf + i, neon_convert8(src + i));
+    }
+    scalar_convert_mono(outbuf + i, src + i, samples - i);
+}
+
+static void neon_convert_stereo(sample * outbuf, const float * left, const float * right, int samples) {
+    int i;
+    for (i = 0; i + 8 <= samples; i += 8) {
+        int16x8x2_t lr;
+        lr.val[0] = neon_convert8(left + i);
+        lr.val[1] = neon_convert8(right + i);
+        vst2q_s16(outbuf + i*2, lr);
+    }
+    scalar_convert_stereo(outbuf + i*2, left + i, right + i, samples - i);
+}
+
+static const pcm_kernels neon_kernels = { "neon", neon_convert_mono, neon_convert_stereo };
+#endif
+
+
+/* ********************************************** */
+
+static const pcm_kernels * select_kernels(void) {
+    const pcm_kernels * selected = &scalar_kernels;
+
+#ifdef PCM_USE_SSE2
+    selected = &sse2_kernels; /* always in x86-64 */
+#endif
+#ifdef PCM_USE_AVX2
+    if (cpu_has_avx2())
+        selected = &avx2_kernels;
+#endif
+#ifdef PCM_USE_NEON
+    selected = &neon_kernels; /* always in aarch64 */
+#endif
+
+    VGM_LOG("VORBIS: using %s PCM conversion\n", selected->name);
+    return selected;
+}
+
+/* set once on first use (racing threads would set the same value) */
+static const pcm_kernels * kernels = NULL;
+
+static inline void interleave_block(sample * outbuf, sample block[PCM_BLOCK_CHANNELS][PCM_BLOCK_FRAMES], int channels, int frames) {
+    int i, ch;
+    for (i = 0; i < frames; i++) {
+        for (ch = 0; ch < channels; ch++) {
+            outbuf[i*channels + ch] = block[ch][i];
+        }
+    }
+}
+
+/* Converts float PCM from libvorbis to interleaved 16-bit PCM. */
+void vorbis_custom_pcm_convert(sample * outbuf, float ** pcm, int channels, int samples_to_do) {
+    sample block[PCM_BLOCK_CHANNELS][PCM_BLOCK_FRAMES];
+    int i, ch, frames;
+
+    if (!kernels)
+        kernels = select_kernels();
+
+    switch(channels) {
+        case 1:
+            kernels->convert_mono(outbuf, pcm[0], samples_to_do);
+            return;
+        case 2:
+            kernels->convert_stereo(outbuf, pcm[0], pcm[1], samples_to_do);
+            return;
+        default:
+            break;
+    }
+
+    if (channels > PCM_BLOCK_CHANNELS) {
+        for (i = 0; i < samples_to_do; i++) {
+            for (ch = 0; ch < channels; ch++) {
+                outbuf[i*channels + ch] = convert_sample(pcm[ch][i]);
+            }
+        }
+        return;
+    }
+
+    /* convert a few frames per channel (contiguous), then interleave them from the cache-hot block,
+     * with constant channels for common layouts so the inner loop gets unrolled */
+    for (i = 0; i < samples_to_do; i += frames) {
+        frames = samples_to_do - i;
+        if (frames > PCM_BLOCK_FRAMES)
+            frames = PCM_BLOCK_FRAMES;
+
+        for (ch = 0; ch < channels; ch++) {
+            kernels->convert_mono(block[ch], pcm[ch] + i, frames);
+        }
+
+        switch(channels) {
+            case 6:  interleave_block(outbuf + i*channels, block, 6, frames); break; /* 5.1 */
+            case 8:  interleave_block(outbuf + i*channels, block, 8, frames); break; /* 7.1 */
+            default: interleave_block(outbuf + i*channels, block, channels, frames); break;
+        }
+    }
+}
+
+static inline int32_t convert_sample_s32(float f) {
+    double val = floor(f * 2147483648.0 + .5);
+
+    if (!(val >= -2147483648.0)) val = -2147483648.0; /* also NaN */
+    if (val > 2147483647.0) val = 2147483647.0;
+    return (int32_t)val;
+}
+
+/* Converts float PCM from libvorbis to samples of any format. Float is copied as-is (like ov_read_float),
+ * so callers mixing in float don't pay for quantizing to 16-bit. Planar formats are copied per channel
+ * without interleaving (outbuf is a void** then). */
+void vorbis_custom_pcm_convert_fmt(void * outbuf, sample_fmt_t fmt, float ** pcm, int channels, int samples_to_do) {
+    int i, ch;
+
+    if (is_sample_fmt_planar(fmt)) {
+        void ** outbufs = outbuf;
+
+        if (!kernels)
+            kernels = select_kernels();
+
+        for (ch = 0; ch < channels; ch++) {
+            switch(fmt) {
+                case SAMPLE_FMT_FLOATP:
+                    memcpy(outbufs[ch], pcm[ch], samples_to_do * sizeof(float));
+                    break;
+                case SAMPLE_FMT_S32P: {
+                    int32_t * dst = outbufs[ch];
+                    for (i = 0; i < samples_to_do; i++) {
+                        dst[i] = convert_sample_s32(pcm[ch][i]);
+                    }
+                    break;
+                }
+                default:
+                    kernels->convert_mono(outbufs[ch], pcm[ch], samples_to_do);
+                    break;
+            }
+        }
+        return;
+    }
+
+    switch(fmt) {
+        case SAMPLE_FMT_FLOAT: {
+            float * outf = outbuf;
+
+            if (channels == 1) {
+                memcpy(outf, pcm[0], samples_to_do * sizeof(float));
+                break;
+            }
+            for (ch = 0; ch < channels; ch++) {
+                const float * src = pcm[ch];
+                float * dst = outf + ch;
+                for (i = 0; i < samples_to_do; i++) {
+                    dst[i*channels] = src[i];
+                }
+            }
+            break;
+        }
+
+        case SAMPLE_FMT_S32: {
+            int32_t * out32 = outbuf;
+
+            for (ch = 0; ch < channels; ch++) {
+                const float * src = pcm[ch];
+                int32_t * dst = out32 + ch;
+                for (i = 0; i < samples_to_do; i++) {
+                    dst[i*channels] = convert_sample_s32(src[i]);
+                }
+            }
+            break;
+        }
+
+        default:
+            vorbis_custom_pcm_convert(outbuf, pcm, channels, samples_to_do);
+            break;
+    }
+}
+
+/* Passes libvorbis PCM to a sink in fmt: float planar as-is, others converted through buf
+ * (buf_samples per channel, of the biggest sample size). Returns 0 if the sink wants to stop. */
+int vorbis_custom_pcm_sink(float ** pcm, int channels, int samples, sample_fmt_t fmt, void * buf, int buf_samples, vgmstream_sink_t sink, void * user_data) {
+    float * pcm_buf[VGMSTREAM_MAX_CHANNELS];
+    void * planar_buf[VGMSTREAM_MAX_CHANNELS];
+    size_t sample_size = get_sample_fmt_size(fmt);
+    int ch, samples_done = 0;
+
+    if (fmt == SAMPLE_FMT_FLOATP)
+        return sink(user_data, pcm, fmt, samples, channels);
+
+    for (ch = 0; ch < channels; ch++) {
+        planar_buf[ch] = (uint8_t*)buf + ch * buf_samples * sample_size;
+    }
+
+    while (samples_done < samples) {
+        void * outbuf = is_sample_fmt_planar(fmt) ? (void*)planar_buf : buf;
+        int samples_to_do = samples - samples_done;
+        if (samples_to_do > buf_samples)
+            samples_to_do = buf_samples;
+
+        for (ch = 0; ch < channels; ch++) {
+            pcm_buf[ch] = pcm[ch] + samples_done;
+        }
+
+        vorbis_custom_pcm_convert_fmt(outbuf, fmt, pcm_buf, channels, samples_to_do);
+        if (!sink(user_data, outbuf, fmt, samples_to_do, channels))
+            return 0;
+
+        samples_done += samples_to_do;
+    }
+
+    return 1;
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "vorbis_custom_decoder.h"
+
+#ifdef VGM_USE_VORBIS
+#include <vorbis/codec.h>
+
+#define REMUX_OGG_SERIAL 0x76676D73 /* "vgms", any value is fine for a single logical stream */
+
+static int remux_ogg(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data, int32_t num_samples, vgmstream_write_t write, void * user_data);
+static int write_pages(ogg_stream_state * os, int flush, vgmstream_write_t write, void * user_data);
+static int parse_packet(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data);
+
+
+/**
+ * Remuxes custom Vorbis into a standard Ogg Vorbis stream, without decoding.
+ *
+ * Custom packets are already rebuilt into standard Vorbis packets for libvorbis (see parse_packet
+ * functions), and the header triad is kept from setup, so we only need to put them into Ogg pages
+ * with proper granule positions. Granules are the end sample of each packet (first audio packet
+ * outputs nothing, then prev_blocksize/4 + blocksize/4), with the last one trimmed to num_samples
+ * so players stop at the same sample as our decoder.
+ *
+ * The stream is reset before and after remuxing. Returns 1 if the whole stream was written.
+ */
+int vorbis_custom_remux_ogg(VGMSTREAM * vgmstream, vgmstream_write_t write, void * user_data) {
+    int ok;
+
+    reset_vgmstream(vgmstream);
+    ok = remux_ogg(&vgmstream->ch[0], vgmstream->codec_data, vgmstream->num_samples, write, user_data);
+    reset_vgmstream(vgmstream);
+
+    return ok;
+}
+
+/**
+ * Remuxes a FSB Vorbis stream into Ogg Vorbis given its FSB header values, without a VGMSTREAM.
+ *
+ * FSB packets are plain Vorbis with a size prefix and the setup comes from the fvs list, so this only needs
+ * parsed headers: no decoder state is made (parsed setups are shared between streams), which makes remuxing
+ * whole banks stream by stream cheap. config needs channels, sample_rate, setup_id, and stream_size if the
+ * stream isn't at the end of the file (FSB5 subsongs).
+ */
+int vorbis_custom_remux_ogg_fsb(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_config * config, int32_t num_samples, vgmstream_write_t write, void * user_data) {
+    vorbis_custom_codec_data * data = NULL;
+    vorbis_custom_config cfg = *config; /* don't modify caller's config */
+    VGMSTREAMCHANNEL stream;
+    int ok;
+
+    cfg.stream_offset = start_offset;
+
+    data = init_vorbis_custom_headers(streamFile, start_offset, VORBIS_FSB, &cfg);
+    if (!data) return 0;
+
+    memset(&stream, 0, sizeof(VGMSTREAMCHANNEL));
+    stream.streamfile = streamFile;
+    stream.channel_start_offset = start_offset;
+    stream.offset = start_offset;
+
+    ok = remux_ogg(&stream, data, num_samples, write, user_data);
+
+    free_vorbis_custom(data);
+    return ok;
+}
+
+static int remux_ogg(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data, int32_t num_samples, vgmstream_write_t write, void * user_data) {
+    ogg_stream_state os;
+    ogg_packet op;
+    uint8_t * packet_buf = NULL;
+    int64_t granule = 0;
+    int prev_blocksize = 0, has_packet = 0, ok, i;
+    off_t header_offset = 0;
+
+    if (!data || !data->vi || data->header_count != 3)
+        return 0;
+
+    if (ogg_stream_init(&os, REMUX_OGG_SERIAL) != 0)
+        return 0;
+
+    packet_buf = malloc(data->buffer_size);
+    if (!packet_buf) goto fail;
+
+
+    /* header triad: identification must be alone in the first page, and audio must start in a new page */
+    for (i = 0; i < 3; i++) {
+        memset(&op, 0, sizeof(ogg_packet));
+        op.packet = data->header_data + header_offset;
+        op.bytes = data->header_sizes[i];
+        op.b_o_s = (i == 0);
+        op.packetno = i;
+        header_offset += data->header_sizes[i];
+
+        if (ogg_stream_packetin(&os, &op) != 0) goto fail;
+        if (i == 0 || i == 2) {
+            if (!write_pages(&os, 1, write, user_data)) goto fail;
+        }
+    }
+
+
+    /* audio packets, one behind so the last one can be flagged */
+    memset(&op, 0, sizeof(ogg_packet));
+    op.packet = packet_buf;
+    op.packetno = 3;
+    do {
+        int blocksize = 0;
+
+        ok = granule < num_samples && parse_packet(stream, data);
+        if (ok) {
+            blocksize = vorbis_packet_blocksize(data->vi, &data->op);
+            if (blocksize <= 0) /* not audio (rare), ignore like the decoder but keep the pending one */
+                continue;
+        }
+
+        /* pending packet is only written once the next audio packet (or the end) is found */
+        if (has_packet) {
+            op.e_o_s = !ok;
+            if (ogg_stream_packetin(&os, &op) != 0) goto fail;
+            if (!write_pages(&os, 0, write, user_data)) goto fail;
+            op.packetno++;
+        }
+
+        if (!ok)
+            break;
+
+        if (prev_blocksize)
+            granule += prev_blocksize / 4 + blocksize / 4;
+        prev_blocksize = blocksize;
+
+        memcpy(packet_buf, data->op.packet, data->op.bytes);
+        op.bytes = data->op.bytes;
+        op.granulepos = granule > num_samples ? num_samples : granule;
+        has_packet = 1;
+    }
+    while (1);
+
+    if (!write_pages(&os, 1, write, user_data)) goto fail;
+
+    ogg_stream_clear(&os);
+    free(packet_buf);
+    return 1;
+
+fail:
+    VGM_LOG("VORBIS: remux fail\n");
+    ogg_stream_clear(&os);
+    free(packet_buf);
+    return 0;
+}
+
+/* reads the next packet into data->op, if any left */
+static int parse_packet(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data * data) {
+    size_t stream_size = get_streamfile_size(stream->streamfile);
+
+    if (data->config.stream_size)
+        stream_size = data->config.stream_offset + data->config.stream_size;
+    if (stream->offset >= stream_size)
+        return 0;
+
+    switch(data->type) {
+        case VORBIS_FSB:    return vorbis_custom_parse_packet_fsb(stream, data);
+        case VORBIS_WWISE:  return vorbis_custom_parse_packet_wwise(stream, data);
+        case VORBIS_OGL:    return vorbis_custom_parse_packet_ogl(stream, data);
+        case VORBIS_SK:     return vorbis_custom_parse_packet_sk(stream, data);
+        case VORBIS_VID1:   return vorbis_custom_parse_packet_vid1(stream, data);
+        default: return 0;
+    }
+}
+
+static int write_pages(ogg_stream_state * os, int flush, vgmstream_write_t write, void * user_data) {
+    ogg_page og;
+
+    while (flush ? ogg_stream_flush(os, &og) : ogg_stream_pageout(os, &og)) {
+        if (!write(user_data, og.header, og.header_len))
+            return 0;
+        if (!write(user_data, og.body, og.body_len))
+            return 0;
+    }
+
+    return 1;
+}
+
+#endif
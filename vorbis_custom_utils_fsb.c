@@ -15,11 +15,9 @@
 
 static int build_header_identification(uint8_t * buf, size_t bufsize, int channels, int sample_rate, int blocksize_short, int blocksize_long);
 static int build_header_comment(uint8_t * buf, size_t bufsize);
-static int build_header_setup(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile);
+static const uint8_t * build_header_setup(uint32_t setup_id, STREAMFILE *streamFile, size_t * setup_size);
 
-static int load_fvs_file_single(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile);
-static int load_fvs_file_multi(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile);
-static int load_fvs_array(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile);
+static const uint8_t * load_fvs_array(uint32_t setup_id, size_t * setup_size);
 
 
 /* **************************************************************************** */
@@ -34,18 +32,25 @@ static int load_fvs_array(uint8_t * buf, size_t bufsize, uint32_t setup_id, STRE
  */
 int vorbis_custom_setup_init_fsb(STREAMFILE *streamFile, off_t start_offset, vorbis_custom_codec_data *data) {
     vorbis_custom_config cfg = data->config;
+    const uint8_t * setup;
+    size_t setup_size = 0;
+    int rc;
 
     data->op.bytes = build_header_identification(data->buffer, data->buffer_size, cfg.channels, cfg.sample_rate, 256, 2048); /* FSB default block sizes */
     if (!data->op.bytes) goto fail;
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse identification header */
+    if (vorbis_custom_headerin(data) != 0) goto fail; /* parse identification header */
 
     data->op.bytes = build_header_comment(data->buffer, data->buffer_size);
     if (!data->op.bytes) goto fail;
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) !=0 ) goto fail; /* parse comment header */
+    if (vorbis_custom_headerin(data) !=0 ) goto fail; /* parse comment header */
 
-    data->op.bytes = build_header_setup(data->buffer, data->buffer_size, cfg.setup_id, streamFile);
-    if (!data->op.bytes) goto fail;
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse setup header */
+    setup = build_header_setup(cfg.setup_id, streamFile, &setup_size);
+    if (!setup) goto fail;
+    data->op.packet = (uint8_t *)setup; /* may point to the precompiled list (only read) */
+    data->op.bytes = setup_size;
+    rc = vorbis_custom_headerin(data); /* parse setup header */
+    data->op.packet = data->buffer;
+    if (rc != 0) goto fail;
 
     return 1;
 
@@ -58,15 +63,40 @@ int vorbis_custom_parse_packet_fsb(VGMSTREAMCHANNEL *stream, vorbis_custom_codec
     size_t bytes;
 
     /* get next packet size from the FSB 16b header (doesn't count this 16b) */
-    data->op.bytes = (uint16_t)read_16bitLE(stream->offset, stream->streamfile);
+    bytes = (uint16_t)read_16bitLE(stream->offset, stream->streamfile);
     stream->offset += 2;
-    if (data->op.bytes == 0 || data->op.bytes == 0xFFFF || data->op.bytes > data->buffer_size) goto fail; /* EOF or end padding */
+    if (bytes == 0 || bytes == 0xFFFF || bytes > data->buffer_size) goto fail; /* EOF or end padding */
+
+    /* raw block (untouched, so no need to copy) */
+    if (!vorbis_custom_read_packet(stream->streamfile, stream->offset, bytes, data)) goto fail; /* wrong packet? */
+    stream->offset += bytes;
+
+    return 1;
+
+fail:
+    return 0;
+}
+
+/* gets packet size (with header) and blocksize without reading the whole packet */
+int vorbis_custom_packet_info_fsb(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize) {
+    uint8_t buf[0x02+0x01];
+    size_t bytes;
+    ogg_packet op = {0};
+    long rc;
+
+    if (read_streamfile(buf, offset, sizeof(buf), streamFile) != sizeof(buf)) goto fail;
+
+    bytes = (uint16_t)get_16bitLE(buf);
+    if (bytes == 0 || bytes == 0xFFFF || bytes > data->buffer_size) goto fail; /* EOF or end padding */
 
-    /* read raw block */
-    bytes = read_streamfile(data->buffer,stream->offset, data->op.bytes,stream->streamfile);
-    stream->offset += data->op.bytes;
-    if (bytes != data->op.bytes) goto fail; /* wrong packet? */
+    /* first byte has packet type + mode */
+    op.packet = buf + 0x02;
+    op.bytes = 0x01;
+    rc = vorbis_packet_blocksize(data->vi, &op);
+    if (rc <= 0) goto fail;
 
+    *packet_size = 0x02 + bytes;
+    *blocksize = rc;
     return 1;
 
 fail:
@@ -137,133 +167,57 @@ static int build_header_comment(uint8_t * buf, size_t bufsize) {
     return bytes;
 }
 
-static int build_header_setup(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile) {
-    int bytes;
+/* returns the setup from the precompiled list, or from external files */
+static const uint8_t * build_header_setup(uint32_t setup_id, STREAMFILE *streamFile, size_t * setup_size) {
+    const uint8_t * setup;
 
     /* try to locate from the precompiled list */
-    bytes = load_fvs_array(buf, bufsize, setup_id, streamFile);
-    if (bytes)
-        return bytes;
-
-    /* try to load from external files */
-    bytes = load_fvs_file_single(buf, bufsize, setup_id, streamFile);
-    if (bytes)
-        return bytes;
-
-    bytes = load_fvs_file_multi(buf, bufsize, setup_id, streamFile);
-    if (bytes)
-        return bytes;
-
-    /* not found */
-    VGM_LOG("FSB Vorbis: setup_id %08x not found\n", setup_id);
-    return 0;
-}
-
-static int load_fvs_file_single(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile) {
-    STREAMFILE * streamFileSetup = NULL;
+    setup = load_fvs_array(setup_id, setup_size);
+    if (setup)
+        return setup;
 
+    /* try to load from external files: "(dir/).fvs_{setup_id}" first, then "(dir/).fvs" */
     {
         char setupname[PATH_LIMIT];
-        char pathname[PATH_LIMIT];
-        char *path;
-
-        /* read "(dir/).fvs_{setup_id}" */
-        streamFile->get_name(streamFile,pathname,sizeof(pathname));
-        path = strrchr(pathname,DIR_SEPARATOR);
-        if (path)
-            *(path+1) = '\0';
-        else
-            pathname[0] = '\0';
-
-        snprintf(setupname,PATH_LIMIT,"%s.fvs_%08x", pathname, setup_id);
-        streamFileSetup = streamFile->open(streamFile,setupname,STREAMFILE_DEFAULT_BUFFER_SIZE);
-    }
-
-    if (streamFileSetup) {
-        /* file found, get contents into the buffer */
-        size_t bytes = streamFileSetup->get_size(streamFileSetup);
-        if (bytes > bufsize) goto fail;
-
-        if (read_streamfile(buf, 0, bytes, streamFileSetup) != bytes)
-            goto fail;
 
-        streamFileSetup->close(streamFileSetup);
-        return bytes;
+        snprintf(setupname,PATH_LIMIT,".fvs_%08x", setup_id);
+        setup = vorbis_custom_library_find(streamFile, setupname, VORBIS_LIBRARY_RAW, 0, setup_size);
+        if (setup)
+            return setup;
     }
 
-fail:
-    if (streamFileSetup) streamFileSetup->close(streamFileSetup);
-    return 0;
+    setup = vorbis_custom_library_find(streamFile, ".fvs", VORBIS_LIBRARY_FVS, setup_id, setup_size);
+    if (setup)
+        return setup;
+
+    /* not found */
+    VGM_LOG("FSB Vorbis: setup_id %08x not found\n", setup_id);
+    return NULL;
 }
 
-static int load_fvs_file_multi(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile) {
-    STREAMFILE * streamFileSetup = NULL;
+static const uint8_t * load_fvs_array(uint32_t setup_id, size_t * setup_size) {
+#if FSB_VORBIS_USE_PRECOMPILED_FVS
+    int lo, hi;
 
-    {
-        char setupname[PATH_LIMIT];
-        char pathname[PATH_LIMIT];
-        char *path;
-
-        /* read "(dir/).fvs" */
-        streamFile->get_name(streamFile,pathname,sizeof(pathname));
-        path = strrchr(pathname,DIR_SEPARATOR);
-        if (path)
-            *(path+1) = '\0';
-        else
-            pathname[0] = '\0';
-
-        snprintf(setupname,PATH_LIMIT,"%s.fvs", pathname);
-        streamFileSetup = streamFile->open(streamFile,setupname,STREAMFILE_DEFAULT_BUFFER_SIZE);
-    }
+    /* list is sorted by id */
+    lo = 0;
+    hi = sizeof(fvs_list) / sizeof(fvs_info) - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
 
-    if (streamFileSetup) {
-        /* file found: read mini-header (format by bnnm, feel free to change) and locate FVS */
-        int entries, i;
-        uint32_t offset = 0, size = 0;
-
-        if (read_32bitBE(0x0, streamFileSetup) != 0x56465653) goto fail; /* "VFVS" */
-        entries = read_32bitLE(0x08, streamFileSetup); /* 0x04=v0, 0x0c-0x20: reserved */
-        if (entries <= 0) goto fail;
-
-        for (i=0; i < entries; i++) {  /* entry = id, offset, size, reserved */
-            if ((uint32_t)read_32bitLE(0x20 + i*0x10, streamFileSetup) == setup_id) {
-                offset = read_32bitLE(0x24 + i*0x10, streamFileSetup);
-                size = read_32bitLE(0x28 + i*0x10, streamFileSetup);
-                break;
-            }
+        if (fvs_list[mid].id == setup_id) {
+            *setup_size = fvs_list[mid].size;
+            return fvs_list[mid].setup;
         }
-        if (!size || !offset || size > bufsize) goto fail;
-
-        /* read into buf */
-        if (read_streamfile(buf, offset, size, streamFileSetup) != size)
-            goto fail;
-
-        streamFileSetup->close(streamFileSetup);
-        return size;
-    }
-
-fail:
-    if (streamFileSetup) streamFileSetup->close(streamFileSetup);
-    return 0;
-}
-
-static int load_fvs_array(uint8_t * buf, size_t bufsize, uint32_t setup_id, STREAMFILE *streamFile) {
-#if FSB_VORBIS_USE_PRECOMPILED_FVS
-    int i, list_length;
-
-    list_length = sizeof(fvs_list) / sizeof(fvs_info);
-    for (i=0; i < list_length; i++) {
-        if (fvs_list[i].id == setup_id) {
-            if (fvs_list[i].size > bufsize) goto fail;
-            /* found: copy data as-is */
-            memcpy(buf,fvs_list[i].setup, fvs_list[i].size);
-            return fvs_list[i].size;
+        else if (fvs_list[mid].id < setup_id) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
         }
     }
-
-fail:
 #endif
-    return 0;
+    return NULL;
 }
 
 #endif
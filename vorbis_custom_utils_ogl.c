@@ -22,21 +22,21 @@ int vorbis_custom_setup_init_ogl(STREAMFILE *streamFile, off_t start_offset, vor
     packet_size = (uint16_t)read_16bitLE(offset, streamFile) >> 2;
     if (packet_size > data->buffer_size) goto fail;
     data->op.bytes = read_streamfile(data->buffer,offset+2,packet_size, streamFile);
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse identification header */
+    if (vorbis_custom_headerin(data) != 0) goto fail; /* parse identification header */
     offset += 2+packet_size;
 
     /* normal comment packet */
     packet_size = (uint16_t)read_16bitLE(offset, streamFile) >> 2;
     if (packet_size > data->buffer_size) goto fail;
     data->op.bytes = read_streamfile(data->buffer,offset+2,packet_size, streamFile);
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) !=0 ) goto fail; /* parse comment header */
+    if (vorbis_custom_headerin(data) !=0 ) goto fail; /* parse comment header */
     offset += 2+packet_size;
 
     /* normal setup packet */
     packet_size = (uint16_t)read_16bitLE(offset, streamFile) >> 2;
     if (packet_size > data->buffer_size) goto fail;
     data->op.bytes = read_streamfile(data->buffer,offset+2,packet_size, streamFile);
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse setup header */
+    if (vorbis_custom_headerin(data) != 0) goto fail; /* parse setup header */
     offset += 2+packet_size;
 
     /* data starts after triad */
@@ -53,14 +53,13 @@ int vorbis_custom_parse_packet_ogl(VGMSTREAMCHANNEL *stream, vorbis_custom_codec
     size_t bytes;
 
     /* get next packet size from the OGL 16b header (upper 14b) */
-    data->op.bytes = (uint16_t)read_16bitLE(stream->offset, stream->streamfile) >> 2;
+    bytes = (uint16_t)read_16bitLE(stream->offset, stream->streamfile) >> 2;
     stream->offset += 2;
-    if (data->op.bytes == 0 || data->op.bytes == 0xFFFF || data->op.bytes > data->buffer_size) goto fail; /* EOF or end padding */
+    if (bytes == 0 || bytes == 0xFFFF || bytes > data->buffer_size) goto fail; /* EOF or end padding */
 
-    /* read raw block */
-    bytes = read_streamfile(data->buffer,stream->offset, data->op.bytes,stream->streamfile);
-    stream->offset += data->op.bytes;
-    if (bytes != data->op.bytes) goto fail; /* wrong packet? */
+    /* raw block (untouched, so no need to copy) */
+    if (!vorbis_custom_read_packet(stream->streamfile, stream->offset, bytes, data)) goto fail; /* wrong packet? */
+    stream->offset += bytes;
 
     return 1;
 
@@ -68,4 +67,30 @@ fail:
     return 0;
 }
 
+/* gets packet size (with header) and blocksize without reading the whole packet */
+int vorbis_custom_packet_info_ogl(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize) {
+    uint8_t buf[0x02+0x01];
+    size_t bytes;
+    ogg_packet op = {0};
+    long rc;
+
+    if (read_streamfile(buf, offset, sizeof(buf), streamFile) != sizeof(buf)) goto fail;
+
+    bytes = (uint16_t)get_16bitLE(buf) >> 2;
+    if (bytes == 0 || bytes == 0xFFFF || bytes > data->buffer_size) goto fail; /* EOF or end padding */
+
+    /* first byte has packet type + mode */
+    op.packet = buf + 0x02;
+    op.bytes = 0x01;
+    rc = vorbis_packet_blocksize(data->vi, &op);
+    if (rc <= 0) goto fail;
+
+    *packet_size = 0x02 + bytes;
+    *blocksize = rc;
+    return 1;
+
+fail:
+    return 0;
+}
+
 #endif
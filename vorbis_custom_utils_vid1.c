@@ -31,19 +31,19 @@ int vorbis_custom_setup_init_vid1(STREAMFILE *streamFile, off_t start_offset, vo
     get_packet_header(streamFile, &offset, &packet_size);
     if (packet_size > data->buffer_size) goto fail;
     data->op.bytes = read_streamfile(data->buffer,offset,packet_size, streamFile);
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse identification header */
+    if (vorbis_custom_headerin(data) != 0) goto fail; /* parse identification header */
     offset += packet_size;
 
     /* generate comment packet */
     data->op.bytes = build_header_comment(data->buffer, data->buffer_size);
     if (!data->op.bytes) goto fail;
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) !=0 ) goto fail; /* parse comment header */
+    if (vorbis_custom_headerin(data) !=0 ) goto fail; /* parse comment header */
 
     /* normal setup packet */
     get_packet_header(streamFile, &offset, &packet_size);
     if (packet_size > data->buffer_size) goto fail;
     data->op.bytes = read_streamfile(data->buffer,offset,packet_size, streamFile);
-    if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse setup header */
+    if (vorbis_custom_headerin(data) != 0) goto fail; /* parse setup header */
     offset += packet_size;
 
     return 1;
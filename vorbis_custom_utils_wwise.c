@@ -13,10 +13,33 @@
 /* DEFS                                                                         */
 /* **************************************************************************** */
 
+typedef struct {
+    STREAMFILE * streamFile;
+    off_t offset;
+    size_t file_size;
+
+    ogg_sync_state oy;
+    ogg_stream_state os;
+    int stream_init;
+} ogg2ww_reader;
+
+typedef struct {
+    uint8_t * buf;
+    size_t size;
+    size_t capacity;
+} ogg2ww_buffer;
+
 static size_t build_header_identification(uint8_t * buf, size_t bufsize, int channels, int sample_rate, int blocksize_short, int blocksize_long);
 static size_t build_header_comment(uint8_t * buf, size_t bufsize);
 static size_t get_packet_header(STREAMFILE *streamFile, off_t offset, wwise_header_t header_type, int * granulepos, size_t * packet_size, int big_endian);
 static size_t rebuild_packet(uint8_t * obuf, size_t obufsize, STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data * data, int big_endian);
+static size_t rebuild_packet_indexed(uint8_t * obuf, size_t obufsize, STREAMFILE *streamFile, const vorbis_custom_packet * packet, vorbis_custom_codec_data * data);
+static int build_packet_index(STREAMFILE *streamFile, vorbis_custom_codec_data * data);
+static vorbis_custom_packet * find_packet_index(vorbis_custom_codec_data * data, off_t offset);
+static int build_seek_table(STREAMFILE *streamFile, vorbis_custom_codec_data * data);
+static int is_setup_cacheable(const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data);
+static size_t setup_cache_get(uint8_t * obuf, size_t obufsize, const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels);
+static void setup_cache_put(const uint8_t * obuf, size_t obufsize, const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels);
 static size_t rebuild_setup(uint8_t * obuf, size_t obufsize, STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data * data, int big_endian, int channels);
 
 static int ww2ogg_generate_vorbis_packet(vgm_bitstream * ow, vgm_bitstream * iw, STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data * data, int big_endian);
@@ -27,9 +50,18 @@ static int ww2ogg_codebook_library_rebuild_by_id(vgm_bitstream * ow, uint32_t co
 static int ww2ogg_tremor_ilog(unsigned int v);
 static unsigned int ww2ogg_tremor_book_maptype1_quantvals(unsigned int entries, unsigned int dimensions);
 
-static int load_wvc(uint8_t * ibuf, size_t ibufsize, uint32_t codebook_id, wwise_setup_t setup_type, STREAMFILE *streamFile);
-static int load_wvc_file(uint8_t * buf, size_t bufsize, uint32_t codebook_id, STREAMFILE *streamFile);
-static int load_wvc_array(uint8_t * buf, size_t bufsize, uint32_t codebook_id, wwise_setup_t setup_type);
+static int ogg2ww_next_packet(ogg2ww_reader * r, ogg_packet * op);
+static int ogg2ww_parse_header_identification(ogg_packet * op, int * channels, int * sample_rate, int * bitrate, int * blocksize_0_exp, int * blocksize_1_exp);
+static int ogg2ww_generate_wwise_packet(vgm_bitstream * ow, vgm_bitstream * iw, size_t packet_size, const uint8_t * mode_blockflag, int mode_bits);
+static int ogg2ww_generate_wwise_setup(vgm_bitstream * ow, vgm_bitstream * iw, int channels, uint8_t * mode_blockflag, int * mode_bits);
+static int ogg2ww_codebook_library_find(vgm_bitstream * iw, uint32_t * codebook_id);
+static size_t ogg2ww_codebook_rebuild_by_id(uint8_t * buf, size_t bufsize, uint32_t codebook_id);
+static int ogg2ww_buffer_put(ogg2ww_buffer * b, const uint8_t * buf, size_t size);
+static size_t ogg2ww_build_header(uint8_t * buf, size_t bufsize, int channels, int sample_rate, int bitrate, int32_t num_samples,
+        size_t data_size, size_t audio_offset, size_t max_packet_size, int blocksize_0_exp, int blocksize_1_exp);
+
+static const uint8_t * load_wvc(uint32_t codebook_id, wwise_setup_t setup_type, STREAMFILE *streamFile, size_t * cb_size);
+static const uint8_t * load_wvc_array(uint32_t codebook_id, wwise_setup_t setup_type, size_t * cb_size);
 
 
 /* **************************************************************************** */
@@ -55,21 +87,21 @@ int vorbis_custom_setup_init_wwise(STREAMFILE *streamFile, off_t start_offset, v
         header_size = get_packet_header(streamFile, offset, cfg.header_type, (int*)&data->op.granulepos, &packet_size, cfg.big_endian);
         if (!header_size || packet_size > data->buffer_size) goto fail;
         data->op.bytes = read_streamfile(data->buffer,offset+header_size,packet_size, streamFile);
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse identification header */
+        if (vorbis_custom_headerin(data) != 0) goto fail; /* parse identification header */
         offset += header_size + packet_size;
 
         /* normal comment packet */
         header_size = get_packet_header(streamFile, offset, cfg.header_type, (int*)&data->op.granulepos, &packet_size, cfg.big_endian);
         if (!header_size || packet_size > data->buffer_size) goto fail;
         data->op.bytes = read_streamfile(data->buffer,offset+header_size,packet_size, streamFile);
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) !=0 ) goto fail; /* parse comment header */
+        if (vorbis_custom_headerin(data) !=0 ) goto fail; /* parse comment header */
         offset += header_size + packet_size;
 
         /* normal setup packet */
         header_size = get_packet_header(streamFile, offset, cfg.header_type, (int*)&data->op.granulepos, &packet_size, cfg.big_endian);
         if (!header_size || packet_size > data->buffer_size) goto fail;
         data->op.bytes = read_streamfile(data->buffer,offset+header_size,packet_size, streamFile);
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse setup header */
+        if (vorbis_custom_headerin(data) != 0) goto fail; /* parse setup header */
         offset += header_size + packet_size;
     }
     else {
@@ -78,17 +110,17 @@ int vorbis_custom_setup_init_wwise(STREAMFILE *streamFile, off_t start_offset, v
         /* new identificacion packet */
         data->op.bytes = build_header_identification(data->buffer, data->buffer_size, cfg.channels, cfg.sample_rate, cfg.blocksize_0_exp, cfg.blocksize_1_exp);
         if (!data->op.bytes) goto fail;
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse identification header */
+        if (vorbis_custom_headerin(data) != 0) goto fail; /* parse identification header */
 
         /* new comment packet */
         data->op.bytes = build_header_comment(data->buffer, data->buffer_size);
         if (!data->op.bytes) goto fail;
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) !=0 ) goto fail; /* parse comment header */
+        if (vorbis_custom_headerin(data) !=0 ) goto fail; /* parse comment header */
 
         /* rebuild setup packet */
         data->op.bytes = rebuild_setup(data->buffer, data->buffer_size, streamFile, start_offset, data, cfg.big_endian, cfg.channels);
         if (!data->op.bytes) goto fail;
-        if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) goto fail; /* parse setup header */
+        if (vorbis_custom_headerin(data) != 0) goto fail; /* parse setup header */
     }
 
     return 1;
@@ -98,14 +130,55 @@ fail:
 }
 
 
+/* Builds optional indexes to speed up decoding and seeking (not critical if they fail). Must be called after setup. */
+int vorbis_custom_index_wwise(STREAMFILE *streamFile, vorbis_custom_codec_data *data) {
+    vorbis_custom_config cfg = data->config;
+
+    /* modified packets need info from adjacent packets, so precompute it */
+    if (cfg.packet_type == WWV_MODIFIED && cfg.stream_size) {
+        if (!build_packet_index(streamFile, data)) {
+            VGM_LOG("Wwise Vorbis: couldn't build packet index\n");
+        }
+    }
+
+    /* seek table isn't needed to decode, so ignore it if it looks wrong */
+    if (cfg.seek_table_size && cfg.stream_size) {
+        if (!build_seek_table(streamFile, data)) {
+            VGM_LOG("Wwise Vorbis: ignored seek table\n");
+        }
+    }
+
+    return 1;
+}
+
+
 int vorbis_custom_parse_packet_wwise(VGMSTREAMCHANNEL *stream, vorbis_custom_codec_data *data) {
     size_t header_size, packet_size = 0;
+    vorbis_custom_packet * packet;
+
+    /* indexed packets: no need to read headers again */
+    packet = find_packet_index(data, stream->offset);
+    if (packet) {
+        data->op.packet = data->buffer;
+        data->op.bytes = rebuild_packet_indexed(data->buffer, data->buffer_size, stream->streamfile, packet, data);
+        stream->offset += packet->header_size + packet->packet_size;
+        if (!data->op.bytes || data->op.bytes >= 0xFFFF) goto fail;
+
+        return 1;
+    }
 
     /* reconstruct a Wwise packet, if needed; final bytes may be bigger than packet_size so we get the header offsets here */
     header_size = get_packet_header(stream->streamfile, stream->offset, data->config.header_type, (int*)&data->op.granulepos, &packet_size, data->config.big_endian);
     if (!header_size || packet_size > data->buffer_size) goto fail;
 
-    data->op.bytes = rebuild_packet(data->buffer, data->buffer_size, stream->streamfile,stream->offset, data, data->config.big_endian);
+    if (data->config.packet_type == WWV_STANDARD) {
+        /* standard packets are unmodified Vorbis, so use them as-is without going through the bitstream */
+        if (!vorbis_custom_read_packet(stream->streamfile, stream->offset + header_size, packet_size, data)) goto fail;
+    }
+    else {
+        data->op.packet = data->buffer;
+        data->op.bytes = rebuild_packet(data->buffer, data->buffer_size, stream->streamfile,stream->offset, data, data->config.big_endian);
+    }
     stream->offset += header_size + packet_size;
     if (!data->op.bytes || data->op.bytes >= 0xFFFF) goto fail;
 
@@ -115,6 +188,186 @@ fail:
     return 0;
 }
 
+/* gets packet size (with header) and blocksize without reading the whole packet */
+int vorbis_custom_packet_info_wwise(STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data *data, size_t * packet_size, int * blocksize) {
+    size_t header_size, bytes = 0;
+    int granulepos, blockflag;
+    uint8_t first_byte;
+
+    /* indexed packets */
+    if (data->packets) {
+        int packet_current = data->packet_current;
+        vorbis_custom_packet * packet = find_packet_index(data, offset);
+
+        data->packet_current = packet_current; /* not decoding */
+        if (packet) {
+            *packet_size = packet->header_size + packet->packet_size;
+            *blocksize = vorbis_info_blocksize(data->vi, packet->blockflag);
+            return *blocksize > 0;
+        }
+    }
+
+    header_size = get_packet_header(streamFile, offset, data->config.header_type, &granulepos, &bytes, data->config.big_endian);
+    if (!header_size || bytes == 0 || bytes > data->buffer_size) goto fail;
+    if (offset + header_size + bytes > get_streamfile_size(streamFile)) goto fail;
+
+    if (read_streamfile(&first_byte, offset + header_size, 0x01, streamFile) != 0x01) goto fail;
+
+    if (data->config.packet_type == WWV_MODIFIED) {
+        /* no packet type bit, mode_number first */
+        blockflag = data->mode_blockflag[first_byte & ((1 << data->mode_bits) - 1)];
+        *blocksize = vorbis_info_blocksize(data->vi, blockflag);
+    }
+    else {
+        ogg_packet op = {0};
+
+        op.packet = &first_byte;
+        op.bytes = 0x01;
+        *blocksize = vorbis_packet_blocksize(data->vi, &op);
+    }
+    if (*blocksize <= 0) goto fail;
+
+    *packet_size = header_size + bytes;
+    return 1;
+
+fail:
+    return 0;
+}
+
+/**
+ * Packs an Ogg Vorbis file into a Wwise .wem, the reverse of what the above does to decode it (no re-encoding).
+ *
+ * Output is the newer (>2012) RIFF with a 0x30 "fmt " extra, 2-byte packet headers and modified packets,
+ * and a setup that references aoTuV 6.03 codebooks by id (as the Wwise encoder itself is aoTuV). Since ids can
+ * only point to known codebooks, files made by other encoders usually can't be packed. There is no seek table,
+ * and loops aren't kept. Returns 1 if the whole file was written.
+ */
+int vorbis_custom_pack_wwise(STREAMFILE *streamFile, vgmstream_write_t write, void * user_data) {
+    ogg2ww_reader r = {0};
+    ogg2ww_buffer data = {0};
+    ogg_packet op;
+    vgm_bitstream ow, iw;
+    uint8_t obuf[0x8000]; /* Wwise packet/header buffer */
+    uint8_t mode_blockflag[64+1] = {0};
+    int mode_bits = 0, packet_type;
+    int channels = 0, sample_rate = 0, bitrate = 0, blocksize_0_exp = 0, blocksize_1_exp = 0;
+    int64_t granule = 0;
+    size_t audio_offset, max_packet_size = 0, header_size;
+    int i;
+
+    r.streamFile = streamFile;
+    r.file_size = get_streamfile_size(streamFile);
+    ogg_sync_init(&r.oy);
+
+    /* header triad: identification for the fmt, comments are dropped, setup is trimmed */
+    for (i = 0; i < 3; i++) {
+        if (ogg2ww_next_packet(&r, &op) != 1) goto fail;
+        if (op.bytes < 1+6 || op.packet[0] != 0x01 + i*2 || memcmp(op.packet+1, "vorbis", 6) != 0) {
+            VGM_LOG("Wwise Vorbis: pack expected header packet %i\n", i);
+            goto fail;
+        }
+
+        if (i == 0) {
+            if (!ogg2ww_parse_header_identification(&op, &channels, &sample_rate, &bitrate, &blocksize_0_exp, &blocksize_1_exp))
+                goto fail;
+        }
+        else if (i == 2) {
+            memset(obuf, 0, sizeof(obuf));
+
+            ow.buf = obuf + 0x02;
+            ow.bufsize = sizeof(obuf) - 0x02;
+            ow.b_off = 0;
+            ow.mode = BITSTREAM_VORBIS;
+
+            iw.buf = op.packet;
+            iw.bufsize = op.bytes;
+            iw.b_off = 0;
+            iw.mode = BITSTREAM_VORBIS;
+
+            if (!ogg2ww_generate_wwise_setup(&ow, &iw, channels, mode_blockflag, &mode_bits)) goto fail;
+            if (ow.b_off / 8 > 0xFFFF) goto fail;
+
+            put_16bitLE(obuf, ow.b_off / 8);
+            if (!ogg2ww_buffer_put(&data, obuf, 0x02 + ow.b_off / 8)) goto fail;
+        }
+    }
+    audio_offset = data.size;
+
+    /* audio packets */
+    /* Wwise decodes same-size blocks as standard packets (see wwise.c), as they can't be told apart otherwise */
+    packet_type = (blocksize_0_exp == blocksize_1_exp) ? WWV_STANDARD : WWV_MODIFIED;
+    while (1) {
+        size_t packet_size;
+        int rc = ogg2ww_next_packet(&r, &op);
+        if (rc < 0) goto fail;
+        if (rc == 0) break;
+
+        if (op.granulepos >= 0)
+            granule = op.granulepos;
+        if (op.bytes == 0 || (op.packet[0] & 1)) /* empty (no samples) or not audio, ignored by decoders */
+            continue;
+
+        if (packet_type == WWV_STANDARD) {
+            if (op.bytes > sizeof(obuf) - 0x02) goto fail;
+            memcpy(obuf + 0x02, op.packet, op.bytes);
+            packet_size = op.bytes;
+        }
+        else {
+            memset(obuf, 0, sizeof(obuf));
+
+            ow.buf = obuf + 0x02;
+            ow.bufsize = sizeof(obuf) - 0x02;
+            ow.b_off = 0;
+            ow.mode = BITSTREAM_VORBIS;
+
+            iw.buf = op.packet;
+            iw.bufsize = op.bytes;
+            iw.b_off = 0;
+            iw.mode = BITSTREAM_VORBIS;
+
+            if (!ogg2ww_generate_wwise_packet(&ow, &iw, op.bytes, mode_blockflag, mode_bits)) goto fail;
+            packet_size = ow.b_off / 8;
+        }
+
+        /* the decoder rejects rebuilt packets of 0xFFFF and up (modified ones may grow a byte) */
+        if (packet_size + 1 >= 0xFFFF) goto fail;
+        if (packet_size > max_packet_size)
+            max_packet_size = packet_size;
+
+        put_16bitLE(obuf, packet_size);
+        if (!ogg2ww_buffer_put(&data, obuf, 0x02 + packet_size)) goto fail;
+    }
+
+    if (data.size == audio_offset || granule <= 0 || granule > 0x7FFFFFFF) goto fail;
+
+    /* RIFF header, then data (setup + packets, padded to even size) */
+    header_size = ogg2ww_build_header(obuf, sizeof(obuf), channels, sample_rate, bitrate, (int32_t)granule,
+            data.size, audio_offset, max_packet_size, blocksize_0_exp, blocksize_1_exp);
+    if (!header_size) goto fail;
+
+    if (data.size % 2) {
+        uint8_t padding = 0;
+        if (!ogg2ww_buffer_put(&data, &padding, 1)) goto fail;
+    }
+
+    if (!write(user_data, obuf, header_size)) goto fail;
+    if (!write(user_data, data.buf, data.size)) goto fail;
+
+    if (r.stream_init)
+        ogg_stream_clear(&r.os);
+    ogg_sync_clear(&r.oy);
+    free(data.buf);
+    return 1;
+
+fail:
+    VGM_LOG("Wwise Vorbis: pack fail\n");
+    if (r.stream_init)
+        ogg_stream_clear(&r.os);
+    ogg_sync_clear(&r.oy);
+    free(data.buf);
+    return 0;
+}
+
 /* **************************************************************************** */
 /* INTERNAL HELPERS                                                             */
 /* **************************************************************************** */
@@ -189,11 +442,260 @@ fail:
 }
 
 
+/* Transforms a Wwise modified data packet into a real Vorbis one, using precomputed window info */
+static size_t rebuild_packet_indexed(uint8_t * obuf, size_t obufsize, STREAMFILE *streamFile, const vorbis_custom_packet * packet, vorbis_custom_codec_data * data) {
+    vgm_bitstream ow, iw;
+    uint32_t remainder = 0;
+
+    size_t ibufsize = 0x8000; /* arbitrary max size of a packet */
+    uint8_t ibuf[0x8000]; /* Wwise packet buffer (if data can't be used in place) */
+    const uint8_t * packet_data;
+    if (obufsize < ibufsize) goto fail; /* arbitrary expected min */
+    if (packet->packet_size == 0 || packet->packet_size > ibufsize) goto fail;
+
+    /* get Wwise data (no more reads until done) */
+    packet_data = peek_streamfile(ibuf, packet->offset + packet->header_size, packet->packet_size, streamFile);
+    if (!packet_data) goto fail;
+
+    /* prepare helper structs */
+    ow.buf = obuf;
+    ow.bufsize = obufsize;
+    ow.b_off = 0;
+    ow.mode = BITSTREAM_VORBIS;
+
+    iw.buf = (uint8_t *)packet_data; /* only read */
+    iw.bufsize = packet->packet_size;
+    iw.b_off = data->mode_bits; /* mode_number already known */
+    iw.mode = BITSTREAM_VORBIS;
+
+    /* rebuild first bits of packet type and window info (see ww2ogg_generate_vorbis_packet) */
+    w_bits(&ow,  1, 0); /* audio packet type */
+    w_bits(&ow,  data->mode_bits, packet->mode_number);
+    r_bits(&iw,  8-data->mode_bits,&remainder);
+    if (packet->blockflag) {
+        w_bits(&ow,  1, packet->prev_blockflag);
+        w_bits(&ow,  1, packet->next_blockflag);
+    }
+    w_bits(&ow,  8-data->mode_bits, remainder);
+
+    data->prev_blockflag = packet->blockflag; /* in case next packets aren't indexed */
+
+    /* remainder of packet */
+    if (!copy_bits(&ow, &iw, (packet->packet_size - 1) * 8)) goto fail;
+
+    /* remove trailing garbage bits */
+    if (ow.b_off % 8 != 0) {
+        if (!w_bits(&ow,  8 - (ow.b_off % 8), 0)) goto fail;
+    }
+
+    return ow.b_off / 8;
+fail:
+    return 0;
+}
+
+/* Reads all packet headers plus first bytes in a single pass, and saves info needed to rebuild modified packets */
+static int build_packet_index(STREAMFILE *streamFile, vorbis_custom_codec_data * data) {
+    vorbis_custom_packet * packets = NULL;
+    int packet_count = 0, packet_max = 0, i;
+    off_t offset = data->config.stream_offset;
+    off_t stream_end = data->config.stream_offset + data->config.stream_size;
+    size_t file_size = get_streamfile_size(streamFile);
+
+    if (stream_end > file_size) /* truncated/prefetch files */
+        stream_end = file_size;
+
+    while (offset < stream_end) {
+        uint8_t buf[0x08+0x01];
+        size_t header_size, packet_size, bytes;
+        vorbis_custom_packet * packet;
+
+        switch(data->config.header_type) {
+            case WWV_TYPE_8: header_size = 0x08; break;
+            case WWV_TYPE_6: header_size = 0x06; break;
+            case WWV_TYPE_2: header_size = 0x02; break;
+            default: goto fail;
+        }
+
+        bytes = read_streamfile(buf, offset, header_size + 0x01, streamFile);
+        if (bytes < header_size) break; /* eof */
+
+        /* packet size doesn't include header size */
+        if (data->config.header_type == WWV_TYPE_8)
+            packet_size = data->config.big_endian ? (uint32_t)get_32bitBE(buf) : (uint32_t)get_32bitLE(buf);
+        else
+            packet_size = data->config.big_endian ? (uint16_t)get_16bitBE(buf) : (uint16_t)get_16bitLE(buf);
+        if (offset + header_size + packet_size > stream_end)
+            break; /* truncated, leave to the regular parser */
+
+        if (packet_count == packet_max) {
+            vorbis_custom_packet * packets_new;
+
+            packet_max = packet_max ? packet_max * 2 : 0x400;
+            packets_new = realloc(packets, packet_max * sizeof(vorbis_custom_packet));
+            if (!packets_new) goto fail;
+            packets = packets_new;
+        }
+
+        packet = &packets[packet_count];
+        memset(packet, 0, sizeof(vorbis_custom_packet));
+        packet->offset = offset;
+        packet->packet_size = packet_size;
+        packet->header_size = header_size;
+        if (packet_size > 0 && bytes == header_size + 0x01) {
+            packet->mode_number = buf[header_size] & ((1 << data->mode_bits) - 1); /* max 6b, LSB first */
+            packet->blockflag = data->mode_blockflag[packet->mode_number];
+        }
+
+        packet_count++;
+        offset += header_size + packet_size;
+    }
+
+    /* window info from adjacent packets */
+    for (i = 0; i < packet_count; i++) {
+        packets[i].prev_blockflag = (i > 0) ? packets[i-1].blockflag : 0;
+        packets[i].next_blockflag = (i + 1 < packet_count) ? packets[i+1].blockflag : 0;
+    }
+
+    free(data->packets);
+    data->packets = packets;
+    data->packet_count = packet_count;
+    data->packet_current = 0;
+    return 1;
+fail:
+    free(packets);
+    return 0;
+}
+
+/* Finds the index entry at offset, usually the next one when decoding sequentially */
+static vorbis_custom_packet * find_packet_index(vorbis_custom_codec_data * data, off_t offset) {
+    int lo, hi;
+
+    if (!data->packets)
+        return NULL;
+
+    if (data->packet_current < data->packet_count && data->packets[data->packet_current].offset == offset) {
+        return &data->packets[data->packet_current++];
+    }
+
+    /* after seeking/looping */
+    lo = 0;
+    hi = data->packet_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        if (data->packets[mid].offset == offset) {
+            data->packet_current = mid + 1;
+            return &data->packets[mid];
+        }
+        else if (data->packets[mid].offset < offset) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+
+    return NULL;
+}
+
+/* Loads the seek table before the setup, a list of (uint16 sample delta, uint16 offset delta) between
+ * seek points, relative to the audio start. The decoder expects a point's sample to be the first one
+ * output when restarting at that packet (sum of prev_blocksize/4 + blocksize/4 for packets 1..N, as
+ * packet 0 only primes), while Wwise's field could also mean the packet's start before priming. So
+ * with a packet index each point's sample is checked against that, and the table is rejected otherwise
+ * (the decoder then makes its own). Without an index points are only validated against packet starts. */
+static int build_seek_table(STREAMFILE *streamFile, vorbis_custom_codec_data * data) {
+    vorbis_custom_seek * seek_table = NULL;
+    uint8_t * buf = NULL;
+    int entries, seek_count = 0, i;
+    int32_t sample = 0, packet_sample = 0;
+    int packet_number = 0;
+    off_t offset = 0;
+    off_t stream_end = data->config.stream_offset + data->config.stream_size;
+    size_t file_size = get_streamfile_size(streamFile);
+
+    if (stream_end > file_size) /* truncated/prefetch files */
+        stream_end = file_size;
+
+    entries = data->config.seek_table_size / 0x04;
+    if (entries <= 0 || entries > 0x100000) goto fail;
+
+    buf = malloc(entries * 0x04);
+    if (!buf) goto fail;
+    if (read_streamfile(buf, data->config.seek_table_offset, entries * 0x04, streamFile) != entries * 0x04)
+        goto fail;
+
+    seek_table = malloc((entries + 1) * sizeof(vorbis_custom_seek));
+    if (!seek_table) goto fail;
+
+    /* implicit first point */
+    seek_table[seek_count].sample = 0;
+    seek_table[seek_count].offset = data->config.stream_offset;
+    seek_count++;
+
+    for (i = 0; i < entries; i++) {
+        uint16_t sample_delta = data->config.big_endian ? get_16bitBE(buf + i*0x04 + 0x00) : get_16bitLE(buf + i*0x04 + 0x00);
+        uint16_t offset_delta = data->config.big_endian ? get_16bitBE(buf + i*0x04 + 0x02) : get_16bitLE(buf + i*0x04 + 0x02);
+        off_t seek_offset;
+
+        if (sample_delta == 0 && offset_delta == 0)
+            continue; /* padding? */
+
+        sample += sample_delta;
+        offset += offset_delta;
+        seek_offset = data->config.stream_offset + offset;
+        if (seek_offset >= stream_end)
+            break; /* truncated/prefetch files */
+
+        /* must land on a packet */
+        if (data->packets) {
+            int packet_current = data->packet_current;
+            vorbis_custom_packet * packet = find_packet_index(data, seek_offset);
+
+            data->packet_current = packet_current;
+            if (!packet) goto fail;
+
+            /* seek points go forward, so keep adding samples up to this packet */
+            while (packet_number < packet - data->packets) {
+                packet_number++;
+                packet_sample += vorbis_info_blocksize(data->vi, data->packets[packet_number - 1].blockflag) / 4
+                        + vorbis_info_blocksize(data->vi, data->packets[packet_number].blockflag) / 4;
+            }
+            if (packet_number != packet - data->packets || packet_sample != sample) {
+                VGM_LOG("Wwise Vorbis: seek point sample %i at %"PRIx64" doesn't match packet sample %i\n",
+                        sample, (off64_t)seek_offset, packet_sample);
+                goto fail;
+            }
+        }
+        else {
+            int granulepos;
+            size_t header_size, packet_size;
+
+            header_size = get_packet_header(streamFile, seek_offset, data->config.header_type, &granulepos, &packet_size, data->config.big_endian);
+            if (!header_size || packet_size == 0 || seek_offset + header_size + packet_size > stream_end) goto fail;
+        }
+
+        seek_table[seek_count].sample = sample;
+        seek_table[seek_count].offset = seek_offset;
+        seek_count++;
+    }
+
+    free(buf);
+    free(data->seek_table);
+    data->seek_table = seek_table;
+    data->seek_count = seek_count;
+    return 1;
+fail:
+    free(buf);
+    free(seek_table);
+    return 0;
+}
+
 /* Transforms a Wwise setup packet into a real Vorbis one (depending on config). */
 static size_t rebuild_setup(uint8_t * obuf, size_t obufsize, STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data * data, int big_endian, int channels) {
     vgm_bitstream ow, iw;
-    int rc, granulepos;
-    size_t header_size, packet_size;
+    int rc, granulepos, cacheable;
+    size_t header_size, packet_size, bytes;
 
     size_t ibufsize = 0x8000; /* arbitrary max size of a setup packet */
     uint8_t ibuf[0x8000]; /* Wwise setup packet buffer */
@@ -207,6 +709,14 @@ static size_t rebuild_setup(uint8_t * obuf, size_t obufsize, STREAMFILE *streamF
     if (read_streamfile(ibuf,offset+header_size,packet_size, streamFile)!=packet_size)
         goto fail;
 
+    /* streams from the same game usually share setups, so try to reuse a previous rebuild */
+    cacheable = is_setup_cacheable(ibuf, packet_size, data);
+    if (cacheable) {
+        bytes = setup_cache_get(obuf, obufsize, ibuf, packet_size, data, channels);
+        if (bytes)
+            return bytes;
+    }
+
     /* prepare helper structs */
     ow.buf = obuf;
     ow.bufsize = obufsize;
@@ -226,12 +736,172 @@ static size_t rebuild_setup(uint8_t * obuf, size_t obufsize, STREAMFILE *streamF
         goto fail;
     }
 
+    if (cacheable)
+        setup_cache_put(obuf, ow.b_off / 8, ibuf, packet_size, data, channels);
 
     return ow.b_off / 8;
 fail:
     return 0;
 }
 
+/* Process-wide cache of rebuilt setups. Entries are keyed by the raw Wwise setup plus config that affects the
+ * rebuild, and also keep the mode info the rebuild sets (needed for modified packets). Oldest entries are
+ * replaced when full. */
+#define WWISE_SETUP_CACHE_MAX 64
+
+typedef struct {
+    uint64_t hash;
+    wwise_setup_t setup_type;
+    int channels;
+    int blocksize_0_exp;
+    int blocksize_1_exp;
+
+    uint8_t * raw;          /* original Wwise setup */
+    size_t raw_size;
+    uint8_t * setup;        /* rebuilt Vorbis setup */
+    size_t setup_size;
+
+    uint8_t mode_blockflag[64+1];
+    int mode_bits;
+} wwise_setup_cache_entry;
+
+static wwise_setup_cache_entry setup_cache[WWISE_SETUP_CACHE_MAX];
+static int setup_cache_count = 0;
+static int setup_cache_next = 0; /* slot to replace when full */
+static vgm_mutex_t setup_cache_mutex = VGM_MUTEX_INIT;
+
+/* Setups with codebook ids outside the precompiled lists also depend on the (dir/).wvc file that
+ * had them, so their rebuilds can't be shared between streams from different dirs. */
+static int is_setup_cacheable(const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data) {
+    vgm_bitstream iw;
+    uint32_t codebook_count_less1 = 0;
+    int i;
+
+    if (data->config.setup_type != WWV_EXTERNAL_CODEBOOKS && data->config.setup_type != WWV_AOTUV603_CODEBOOKS)
+        return 1; /* codebooks are in the setup */
+
+    iw.buf = (uint8_t *)ibuf; /* only read */
+    iw.bufsize = ibufsize;
+    iw.b_off = 0;
+    iw.mode = BITSTREAM_VORBIS;
+
+    if (!r_bits(&iw, 8,&codebook_count_less1))
+        return 0;
+    for (i = 0; i < codebook_count_less1 + 1; i++) {
+        uint32_t codebook_id = 0;
+        size_t cb_size;
+
+        if (!r_bits(&iw, 10,&codebook_id))
+            return 0;
+        if (!load_wvc_array(codebook_id, data->config.setup_type, &cb_size))
+            return 0;
+    }
+
+    return 1;
+}
+
+static uint64_t setup_cache_hash(const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels) {
+    uint8_t cfg[0x10];
+    uint64_t hash;
+
+    put_32bitLE(cfg + 0x00, data->config.setup_type);
+    put_32bitLE(cfg + 0x04, channels);
+    put_32bitLE(cfg + 0x08, data->config.blocksize_0_exp);
+    put_32bitLE(cfg + 0x0c, data->config.blocksize_1_exp);
+
+    hash = hash_fnv1a(VGM_HASH_INIT, cfg, sizeof(cfg));
+    hash = hash_fnv1a(hash, ibuf, ibufsize);
+    return hash;
+}
+
+static int setup_cache_match(wwise_setup_cache_entry * entry, uint64_t hash, const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels) {
+    return entry->hash == hash &&
+            entry->setup_type == data->config.setup_type &&
+            entry->channels == channels &&
+            entry->blocksize_0_exp == data->config.blocksize_0_exp &&
+            entry->blocksize_1_exp == data->config.blocksize_1_exp &&
+            entry->raw_size == ibufsize &&
+            memcmp(entry->raw, ibuf, ibufsize) == 0;
+}
+
+/* copies a cached setup to obuf and restores mode info, returns 0 if not found */
+static size_t setup_cache_get(uint8_t * obuf, size_t obufsize, const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels) {
+    uint64_t hash = setup_cache_hash(ibuf, ibufsize, data, channels);
+    size_t bytes = 0;
+    int i;
+
+    vgm_mutex_lock(&setup_cache_mutex);
+    for (i = 0; i < setup_cache_count; i++) {
+        wwise_setup_cache_entry * entry = &setup_cache[i];
+
+        if (!setup_cache_match(entry, hash, ibuf, ibufsize, data, channels))
+            continue;
+        if (entry->setup_size > obufsize)
+            break;
+
+        memcpy(obuf, entry->setup, entry->setup_size);
+        memcpy(data->mode_blockflag, entry->mode_blockflag, sizeof(data->mode_blockflag));
+        data->mode_bits = entry->mode_bits;
+        bytes = entry->setup_size;
+        break;
+    }
+    vgm_mutex_unlock(&setup_cache_mutex);
+
+    return bytes;
+}
+
+static void setup_cache_put(const uint8_t * obuf, size_t obufsize, const uint8_t * ibuf, size_t ibufsize, vorbis_custom_codec_data * data, int channels) {
+    uint64_t hash = setup_cache_hash(ibuf, ibufsize, data, channels);
+    wwise_setup_cache_entry * entry;
+    uint8_t * raw = NULL, * setup = NULL;
+    int i;
+
+    raw = malloc(ibufsize);
+    setup = malloc(obufsize);
+    if (!raw || !setup) goto fail;
+    memcpy(raw, ibuf, ibufsize);
+    memcpy(setup, obuf, obufsize);
+
+    vgm_mutex_lock(&setup_cache_mutex);
+
+    /* may be added by another thread meanwhile */
+    for (i = 0; i < setup_cache_count; i++) {
+        if (setup_cache_match(&setup_cache[i], hash, ibuf, ibufsize, data, channels)) {
+            vgm_mutex_unlock(&setup_cache_mutex);
+            goto fail;
+        }
+    }
+
+    if (setup_cache_count < WWISE_SETUP_CACHE_MAX) {
+        entry = &setup_cache[setup_cache_count];
+        setup_cache_count++;
+    }
+    else {
+        entry = &setup_cache[setup_cache_next];
+        setup_cache_next = (setup_cache_next + 1) % WWISE_SETUP_CACHE_MAX;
+        free(entry->raw);
+        free(entry->setup);
+    }
+
+    entry->hash = hash;
+    entry->setup_type = data->config.setup_type;
+    entry->channels = channels;
+    entry->blocksize_0_exp = data->config.blocksize_0_exp;
+    entry->blocksize_1_exp = data->config.blocksize_1_exp;
+    entry->raw = raw;
+    entry->raw_size = ibufsize;
+    entry->setup = setup;
+    entry->setup_size = obufsize;
+    memcpy(entry->mode_blockflag, data->mode_blockflag, sizeof(entry->mode_blockflag));
+    entry->mode_bits = data->mode_bits;
+
+    vgm_mutex_unlock(&setup_cache_mutex);
+    return;
+fail:
+    free(raw);
+    free(setup);
+}
+
 static size_t build_header_identification(uint8_t * buf, size_t bufsize, int channels, int sample_rate, int blocksize_0_exp, int blocksize_1_exp) {
     size_t bytes = 0x1e;
     uint8_t blocksizes;
@@ -283,7 +953,7 @@ static size_t build_header_comment(uint8_t * buf, size_t bufsize) {
 /* Copy packet as-is or rebuild first byte if mod_packets is used.
  * (ref: https://www.xiph.org/vorbis/doc/Vorbis_I_spec.html#x1-720004.3) */
 static int ww2ogg_generate_vorbis_packet(vgm_bitstream * ow, vgm_bitstream * iw, STREAMFILE *streamFile, off_t offset, vorbis_custom_codec_data * data, int big_endian) {
-    int i,granule;
+    int granule;
     size_t header_size, packet_size, data_size;
 
     header_size = get_packet_header(streamFile,offset, data->config.header_type, &granule, &packet_size, big_endian);
@@ -375,11 +1045,8 @@ static int ww2ogg_generate_vorbis_packet(vgm_bitstream * ow, vgm_bitstream * iw,
 
 
     /* remainder of packet (not byte-aligned when using mod_packets) */
-    for (i = 1; i < packet_size; i++) {
-        uint32_t c = 0;
-
-        r_bits(iw,  8, &c);
-        w_bits(ow,  8,  c);
+    if (packet_size > 1) {
+        if (!copy_bits(ow, iw, (packet_size - 1) * 8)) goto fail;
     }
 
     /* remove trailing garbage bits */
@@ -452,14 +1119,11 @@ static int ww2ogg_generate_vorbis_setup(vgm_bitstream * ow, vgm_bitstream * iw,
 
     if (data->config.setup_type == WWV_FULL_SETUP) {
         /* rest of setup is untouched, copy bits */
-        uint32_t bitly = 0;
         uint32_t total_bits_read = iw->b_off;
         uint32_t setup_packet_size_bits = packet_size*8;
 
-        while (total_bits_read < setup_packet_size_bits) {
-            r_bits(iw,  1,&bitly);
-            w_bits(ow,  1, bitly);
-            total_bits_read = iw->b_off;
+        if (total_bits_read < setup_packet_size_bits) {
+            if (!copy_bits(ow, iw, setup_packet_size_bits - total_bits_read)) goto fail;
         }
     }
     else {
@@ -1029,16 +1693,15 @@ fail:
 
 /* rebuilds an external Wwise codebook referenced by id to a Vorbis codebook */
 static int ww2ogg_codebook_library_rebuild_by_id(vgm_bitstream * ow, uint32_t codebook_id, wwise_setup_t setup_type, STREAMFILE *streamFile) {
-    size_t ibufsize = 0x8000; /* arbitrary max size of a codebook */
-    uint8_t ibuf[0x8000]; /* Wwise codebook buffer */
-    size_t cb_size;
+    const uint8_t * cb;
+    size_t cb_size = 0;
     vgm_bitstream iw;
 
-    cb_size = load_wvc(ibuf,ibufsize, codebook_id, setup_type, streamFile);
-    if (cb_size == 0) goto fail;
+    cb = load_wvc(codebook_id, setup_type, streamFile, &cb_size);
+    if (!cb || cb_size == 0) goto fail;
 
-    iw.buf = ibuf;
-    iw.bufsize = ibufsize;
+    iw.buf = (uint8_t *)cb; /* only read */
+    iw.bufsize = cb_size;
     iw.b_off = 0;
     iw.mode = BITSTREAM_VORBIS;
 
@@ -1085,138 +1748,643 @@ static unsigned int ww2ogg_tremor_book_maptype1_quantvals(unsigned int entries,
 
 
 /* **************************************************************************** */
-/* INTERNAL UTILS                                                               */
+/* INTERNAL OGG2WW STUFF                                                        */
 /* **************************************************************************** */
+/* The reverse of the above: trims standard Vorbis packets into Wwise ones, following the same structure
+ * (r_bits from the Vorbis packet, w_bits what Wwise keeps). */
+
+/* reads the next packet of the first logical stream, returns 1 if found, 0 on EOF, -1 on error */
+static int ogg2ww_next_packet(ogg2ww_reader * r, ogg_packet * op) {
+    ogg_page og;
+    int rc;
+
+    while (1) {
+        if (r->stream_init) {
+            rc = ogg_stream_packetout(&r->os, op);
+            if (rc == 1)
+                return 1;
+            if (rc < 0) { /* missing pages */
+                VGM_LOG("Wwise Vorbis: pack found hole in Ogg data\n");
+                return -1;
+            }
+        }
 
-/* loads an external Wwise Vorbis Codebooks file (wvc) referenced by ID and returns size */
-static int load_wvc(uint8_t * ibuf, size_t ibufsize, uint32_t codebook_id, wwise_setup_t setup_type, STREAMFILE *streamFile) {
-    size_t bytes;
+        rc = ogg_sync_pageout(&r->oy, &og);
+        if (rc > 0) {
+            if (!r->stream_init) {
+                if (ogg_stream_init(&r->os, ogg_page_serialno(&og)) != 0)
+                    return -1;
+                r->stream_init = 1;
+            }
+            ogg_stream_pagein(&r->os, &og); /* pages from other logical streams are rejected */
+            continue;
+        }
+        if (rc < 0) /* skipped garbage until next page */
+            continue;
 
-    /* try to locate from the precompiled list */
-    bytes = load_wvc_array(ibuf, ibufsize, codebook_id, setup_type);
-    if (bytes)
-        return bytes;
+        /* need more data */
+        if (r->offset >= r->file_size)
+            return 0;
+        {
+            size_t bytes = r->file_size - r->offset;
+            char * buf;
+
+            if (bytes > 0x4000)
+                bytes = 0x4000;
+            buf = ogg_sync_buffer(&r->oy, bytes);
+            if (!buf) return -1;
+            if (read_streamfile((uint8_t*)buf, r->offset, bytes, r->streamFile) != bytes)
+                return -1;
+            ogg_sync_wrote(&r->oy, bytes);
+            r->offset += bytes;
+        }
+    }
+}
 
-    /* try to load from external file (ignoring type, just use file if found) */
-    bytes = load_wvc_file(ibuf, ibufsize, codebook_id, streamFile);
-    if (bytes)
-        return bytes;
+/* gets fmt info from a Vorbis identification packet (see build_header_identification) */
+static int ogg2ww_parse_header_identification(ogg_packet * op, int * channels, int * sample_rate, int * bitrate, int * blocksize_0_exp, int * blocksize_1_exp) {
+    uint8_t * buf = op->packet;
+    uint8_t blocksizes;
 
-    /* not found */
-    VGM_LOG("Wwise Vorbis: codebook_id %04x not found\n", codebook_id);
+    if (op->bytes < 0x1e) goto fail;
+    if (get_32bitLE(buf+0x07) != 0x00) goto fail; /* vorbis_version */
+
+    *channels       = buf[0x0b];
+    *sample_rate    = get_32bitLE(buf+0x0c);
+    *bitrate        = get_32bitLE(buf+0x14); /* nominal */
+    blocksizes      = buf[0x1c];
+    *blocksize_1_exp = (blocksizes >> 0) & 0x0F; /* small */
+    *blocksize_0_exp = (blocksizes >> 4) & 0x0F; /* big */
+
+    if (*channels == 0 || *sample_rate <= 0) goto fail;
+    if (*blocksize_1_exp < 6 || *blocksize_0_exp > 13 || *blocksize_1_exp > *blocksize_0_exp) goto fail;
+    if (*bitrate < 0)
+        *bitrate = 0;
+
+    return 1;
+fail:
+    VGM_LOG("Wwise Vorbis: pack bad identification header\n");
     return 0;
 }
 
-static int load_wvc_file(uint8_t * buf, size_t bufsize, uint32_t codebook_id, STREAMFILE *streamFile) {
-    STREAMFILE * streamFileWvc = NULL;
-    size_t wvc_size = 0;
+/* Removes packet type and window info bits from a Vorbis audio packet, as Wwise can rebuild them from the
+ * mode and adjacent packets (see ww2ogg_generate_vorbis_packet). */
+static int ogg2ww_generate_wwise_packet(vgm_bitstream * ow, vgm_bitstream * iw, size_t packet_size, const uint8_t * mode_blockflag, int mode_bits) {
+    uint32_t packet_type = 0, mode_number = 0;
+    size_t header_bits;
 
-    {
-        char setupname[PATH_LIMIT];
-        char pathname[PATH_LIMIT];
-        char *path;
-
-        /* read "(dir/).wvc" */
-        streamFile->get_name(streamFile,pathname,sizeof(pathname));
-        path = strrchr(pathname,DIR_SEPARATOR);
-        if (path)
-            *(path+1) = '\0';
-        else
-            pathname[0] = '\0';
+    header_bits = 1 + mode_bits;
+    if (packet_size * 8 < header_bits) goto fail;
+
+    /* audio packet type */
+    r_bits(iw,  1,&packet_type);
+    if (packet_type != 0) goto fail;
 
-        snprintf(setupname,PATH_LIMIT,"%s.wvc", pathname);
-        streamFileWvc = streamFile->open(streamFile,setupname,STREAMFILE_DEFAULT_BUFFER_SIZE);
-        if (!streamFileWvc) goto fail;
+    r_bits(iw,  mode_bits,&mode_number); /* max 6b */
+    w_bits(ow,  mode_bits, mode_number);
 
-        wvc_size = streamFileWvc->get_size(streamFileWvc);
+    /* window info (long windows only) */
+    if (mode_blockflag[mode_number]) {
+        uint32_t prev_window_type = 0, next_window_type = 0;
+
+        if (packet_size * 8 < header_bits + 2) goto fail;
+        r_bits(iw,  1,&prev_window_type);
+        r_bits(iw,  1,&next_window_type);
     }
 
-    /* find codebook and copy to buffer */
-    {
-        off_t table_start, codebook_offset;
-        size_t codebook_size;
-        int codebook_count;
+    /* remainder of packet */
+    if (!copy_bits(ow, iw, packet_size * 8 - iw->b_off)) goto fail;
+
+    /* remove trailing garbage bits */
+    if (ow->b_off % 8 != 0) {
+        uint32_t padding = 0;
+        int padding_bits = 8 - (ow->b_off % 8);
+
+        w_bits(ow,  padding_bits,  padding);
+    }
+
+    return 1;
+fail:
+    return 0;
+}
+
+/* Trims a Vorbis setup into a Wwise setup with external codebooks (see ww2ogg_generate_vorbis_setup).
+ * Removed fields must have the only value Wwise can rebuild, or the file can't be packed. */
+static int ogg2ww_generate_wwise_setup(vgm_bitstream * ow, vgm_bitstream * iw, int channels, uint8_t * mode_blockflag, int * mode_bits) {
+    int i,j,k;
+    uint32_t codebook_count = 0, floor_count = 0, residue_count = 0, mapping_count = 0, mode_count = 0;
+    uint32_t codebook_count_less1 = 0, floor_count_less1 = 0, residue_count_less1 = 0, mapping_count_less1 = 0, mode_count_less1 = 0;
+    uint32_t time_count_less1 = 0, dummy_time_value = 0, framing = 0;
+
 
-        /* at the end of the WVC is an offset table, and we need to find codebook id (number) offset */
-        table_start = read_32bitLE(wvc_size - 4, streamFileWvc); /* last offset */
-        codebook_count = ((wvc_size - table_start) / 4) - 1;
-        if (table_start > wvc_size || codebook_id >= codebook_count) goto fail;
+    /* packet header (checked by caller) */
+    iw->b_off += (1+6) * 8;
 
-        codebook_offset = read_32bitLE(table_start + codebook_id*4, streamFileWvc);
-        codebook_size   = read_32bitLE(table_start + codebook_id*4 + 4, streamFileWvc) - codebook_offset;
-        if (codebook_size > bufsize) goto fail;
 
-        if (read_streamfile(buf, codebook_offset, codebook_size, streamFileWvc) != codebook_size)
+    /* Codebooks: referenced by id */
+    r_bits(iw,  8,&codebook_count_less1);
+    w_bits(ow,  8, codebook_count_less1);
+    codebook_count = codebook_count_less1 + 1;
+
+    for (i = 0; i < codebook_count; i++) {
+        uint32_t codebook_id = 0;
+
+        if (!ogg2ww_codebook_library_find(iw, &codebook_id)) {
+            VGM_LOG("Wwise Vorbis: pack codebook %i not found in library\n", i);
             goto fail;
-        streamFileWvc->close(streamFileWvc);
+        }
+        w_bits(ow, 10, codebook_id);
+    }
 
-        return codebook_size;
+
+    /* Time domain transforms: removed */
+    r_bits(iw,  6,&time_count_less1);
+    r_bits(iw, 16,&dummy_time_value);
+    if (time_count_less1 != 0 || dummy_time_value != 0) {
+        VGM_LOG("Wwise Vorbis: pack unexpected time domain transforms\n");
+        goto fail;
     }
 
 
+    /* Floors */
+    r_bits(iw,  6,&floor_count_less1);
+    w_bits(ow,  6, floor_count_less1);
+    floor_count = floor_count_less1 + 1;
+
+    for (i = 0; i < floor_count; i++) {
+        uint32_t floor_type = 0, floor1_partitions = 0, floor1_multiplier_less1 = 0, rangebits = 0;
+        uint32_t maximum_class = 0;
+        uint32_t floor1_partition_class_list[32]; /* max 5b */
+        uint32_t floor1_class_dimensions_list[16+1]; /* max 4b+1 */
+
+        // Wwise only keeps floor type 1
+        r_bits(iw, 16,&floor_type);
+        if (floor_type != 1) {
+            VGM_LOG("Wwise Vorbis: pack unexpected floor type %i\n", floor_type);
+            goto fail;
+        }
+
+        r_bits(iw,  5,&floor1_partitions);
+        w_bits(ow,  5, floor1_partitions);
+
+        memset(floor1_partition_class_list, 0, sizeof(uint32_t)*32);
+
+        maximum_class = 0;
+        for (j = 0; j < floor1_partitions; j++) {
+            uint32_t floor1_partition_class = 0;
+
+            r_bits(iw,  4,&floor1_partition_class);
+            w_bits(ow,  4, floor1_partition_class);
+
+            floor1_partition_class_list[j] = floor1_partition_class;
+
+            if (floor1_partition_class > maximum_class)
+                maximum_class = floor1_partition_class;
+        }
+
+        memset(floor1_class_dimensions_list, 0, sizeof(uint32_t)*(16+1));
+
+        for (j = 0; j <= maximum_class; j++) {
+            uint32_t class_dimensions_less1 = 0, class_subclasses = 0;
+
+            r_bits(iw,  3,&class_dimensions_less1);
+            w_bits(ow,  3, class_dimensions_less1);
+
+            floor1_class_dimensions_list[j] = class_dimensions_less1 + 1;
+
+            r_bits(iw,  2,&class_subclasses);
+            w_bits(ow,  2, class_subclasses);
+
+            if (0 != class_subclasses) {
+                uint32_t masterbook = 0;
+
+                r_bits(iw,  8,&masterbook);
+                w_bits(ow,  8, masterbook);
+            }
+
+            for (k = 0; k < (1U<<class_subclasses); k++) {
+                uint32_t subclass_book_plus1 = 0;
+
+                r_bits(iw,  8,&subclass_book_plus1);
+                w_bits(ow,  8, subclass_book_plus1);
+            }
+        }
+
+        r_bits(iw,  2,&floor1_multiplier_less1);
+        w_bits(ow,  2, floor1_multiplier_less1);
+
+        r_bits(iw,  4,&rangebits);
+        w_bits(ow,  4, rangebits);
+
+        for (j = 0; j < floor1_partitions; j++) {
+            uint32_t current_class_number = 0;
+
+            current_class_number = floor1_partition_class_list[j];
+            for (k = 0; k < floor1_class_dimensions_list[current_class_number]; k++) {
+                uint32_t X = 0; /* max 4b (15) */
+
+                r_bits(iw,  rangebits,&X);
+                w_bits(ow,  rangebits, X);
+            }
+        }
+    }
+
+
+    /* Residues */
+    r_bits(iw,  6,&residue_count_less1);
+    w_bits(ow,  6, residue_count_less1);
+    residue_count = residue_count_less1 + 1;
+
+    for (i = 0; i < residue_count; i++) {
+        uint32_t residue_type = 0, residue_classifications = 0;
+        uint32_t residue_begin = 0, residue_end = 0, residue_partition_size_less1 = 0, residue_classifications_less1 = 0, residue_classbook = 0;
+        uint32_t residue_cascade[64+1]; /* 6b +1 */
+
+        r_bits(iw, 16,&residue_type);
+        w_bits(ow,  2, residue_type); /* 16b to 2b */
+
+        if (residue_type > 2) {
+            VGM_LOG("Wwise Vorbis: pack invalid residue type\n");
+            goto fail;
+        }
+
+        r_bits(iw, 24,&residue_begin);
+        w_bits(ow, 24, residue_begin);
+        r_bits(iw, 24,&residue_end);
+        w_bits(ow, 24, residue_end);
+        r_bits(iw, 24,&residue_partition_size_less1);
+        w_bits(ow, 24, residue_partition_size_less1);
+        r_bits(iw,  6,&residue_classifications_less1);
+        w_bits(ow,  6, residue_classifications_less1);
+        r_bits(iw,  8,&residue_classbook);
+        w_bits(ow,  8, residue_classbook);
+        residue_classifications = residue_classifications_less1 + 1;
+
+        memset(residue_cascade, 0, sizeof(uint32_t)*(64+1));
+
+        for (j = 0; j < residue_classifications; j++) {
+            uint32_t high_bits = 0, low_bits = 0, bitflag = 0;
+
+            r_bits(iw, 3,&low_bits);
+            w_bits(ow, 3, low_bits);
+
+            r_bits(iw, 1,&bitflag);
+            w_bits(ow, 1, bitflag);
+            if (bitflag) {
+                r_bits(iw, 5,&high_bits);
+                w_bits(ow, 5, high_bits);
+            }
+
+            residue_cascade[j] = high_bits * 8 + low_bits;
+        }
+
+        for (j = 0; j < residue_classifications; j++) {
+            for (k = 0; k < 8; k++) {
+                if (residue_cascade[j] & (1 << k)) {
+                    uint32_t residue_book = 0;
+
+                    r_bits(iw, 8,&residue_book);
+                    w_bits(ow, 8, residue_book);
+                }
+            }
+        }
+    }
+
+
+    /* Mappings */
+    r_bits(iw,  6,&mapping_count_less1);
+    w_bits(ow,  6, mapping_count_less1);
+    mapping_count = mapping_count_less1 + 1;
+
+    for (i = 0; i < mapping_count; i++) {
+        uint32_t mapping_type = 0, submaps_flag = 0, submaps = 0, square_polar_flag = 0;
+        uint32_t mapping_reserved = 0;
+
+        // Wwise only keeps mapping type 0, the only one
+        r_bits(iw, 16,&mapping_type);
+        if (mapping_type != 0) {
+            VGM_LOG("Wwise Vorbis: pack invalid mapping type\n");
+            goto fail;
+        }
+
+        r_bits(iw,  1,&submaps_flag);
+        w_bits(ow,  1, submaps_flag);
+
+        submaps = 1;
+        if (submaps_flag) {
+            uint32_t submaps_less1 = 0;
+
+            r_bits(iw,  4,&submaps_less1);
+            w_bits(ow,  4, submaps_less1);
+            submaps = submaps_less1 + 1;
+        }
+
+        r_bits(iw,  1,&square_polar_flag);
+        w_bits(ow,  1, square_polar_flag);
+
+        if (square_polar_flag) {
+            uint32_t coupling_steps_less1 = 0, coupling_steps = 0;
+
+            r_bits(iw,  8,&coupling_steps_less1);
+            w_bits(ow,  8, coupling_steps_less1);
+            coupling_steps = coupling_steps_less1 + 1;
+
+            for (j = 0; j < coupling_steps; j++) {
+                uint32_t magnitude = 0, angle = 0;
+                int magnitude_bits = ww2ogg_tremor_ilog(channels-1);
+                int angle_bits = ww2ogg_tremor_ilog(channels-1);
+
+                r_bits(iw,  magnitude_bits,&magnitude);
+                w_bits(ow,  magnitude_bits, magnitude);
+                r_bits(iw,  angle_bits,&angle);
+                w_bits(ow,  angle_bits, angle);
+            }
+        }
+
+        r_bits(iw,  2,&mapping_reserved);
+        w_bits(ow,  2, mapping_reserved);
+
+        if (submaps > 1) {
+            for (j = 0; j < channels; j++) {
+                uint32_t mapping_mux = 0;
+
+                r_bits(iw,  4,&mapping_mux);
+                w_bits(ow,  4, mapping_mux);
+            }
+        }
+
+        for (j = 0; j < submaps; j++) {
+            uint32_t time_config = 0, floor_number = 0, residue_number = 0;
+
+            r_bits(iw,  8,&time_config);
+            w_bits(ow,  8, time_config);
+            r_bits(iw,  8,&floor_number);
+            w_bits(ow,  8, floor_number);
+            r_bits(iw,  8,&residue_number);
+            w_bits(ow,  8, residue_number);
+        }
+    }
+
+
+    /* Modes */
+    r_bits(iw,  6,&mode_count_less1);
+    w_bits(ow,  6, mode_count_less1);
+    mode_count = mode_count_less1 + 1;
+
+    memset(mode_blockflag, 0, sizeof(uint8_t)*(64+1)); /* up to max mode_count */
+    *mode_bits = ww2ogg_tremor_ilog(mode_count-1); /* for mod_packets */
+
+    for (i = 0; i < mode_count; i++) {
+        uint32_t block_flag = 0, windowtype = 0, transformtype = 0, mapping = 0;
+
+        r_bits(iw,  1,&block_flag);
+        w_bits(ow,  1, block_flag);
+
+        mode_blockflag[i] = (block_flag != 0); /* for mod_packets */
+
+        r_bits(iw, 16,&windowtype);
+        r_bits(iw, 16,&transformtype);
+        if (windowtype != 0 || transformtype != 0) {
+            VGM_LOG("Wwise Vorbis: pack invalid mode window/transform type\n");
+            goto fail;
+        }
+
+        r_bits(iw,  8,&mapping);
+        w_bits(ow,  8, mapping);
+    }
+
+
+    /* end flag: removed (also catches reading past the setup, as r_bits won't) */
+    if (!r_bits(iw,  1,&framing) || framing != 1) {
+        VGM_LOG("Wwise Vorbis: pack bad setup framing\n");
+        goto fail;
+    }
+
+    /* remove trailing garbage bits */
+    if (ow->b_off % 8 != 0) {
+        uint32_t padding = 0;
+        int padding_bits = 8 - (ow->b_off % 8);
+
+        w_bits(ow,  padding_bits,  padding);
+    }
+
+
+    return 1;
 fail:
-    if (streamFileWvc) streamFileWvc->close(streamFileWvc);
     return 0;
 }
 
-static int load_wvc_array(uint8_t * buf, size_t bufsize, uint32_t codebook_id, wwise_setup_t setup_type) {
-#if WWISE_VORBIS_USE_PRECOMPILED_WVC
 
-    /* get pointer to array */
-    {
-        int i, list_length;
-        const wvc_info * wvc_list;
-
-        switch (setup_type) {
-            case WWV_EXTERNAL_CODEBOOKS:
-                wvc_list = wvc_list_standard;
-                list_length = sizeof(wvc_list_standard) / sizeof(wvc_info);
-                break;
-            case WWV_AOTUV603_CODEBOOKS:
-                wvc_list = wvc_list_aotuv603;
-                list_length = sizeof(wvc_list_standard) / sizeof(wvc_info);
-                break;
-            default:
-                goto fail;
-        }
+/* Index of library codebooks as rebuilt by ww2ogg (total bits + hash), to find the id of a Vorbis codebook.
+ * Built once on first use, as rebuilding the whole library per codebook would be slow. */
+#define WWISE_CODEBOOK_ID_MAX 1024 /* 10b */
 
-        for (i=0; i < list_length; i++) {
-            if (wvc_list[i].id == codebook_id) {
-                if (wvc_list[i].size > bufsize) goto fail;
-                /* found: copy data as-is */
-                memcpy(buf,wvc_list[i].codebook, wvc_list[i].size);
-                return wvc_list[i].size;
-            }
+typedef struct {
+    uint64_t hash;
+    size_t bits;
+} wwise_codebook_index_entry;
+
+static wwise_codebook_index_entry codebook_index[WWISE_CODEBOOK_ID_MAX];
+static int codebook_index_count = -1; /* not built yet */
+static vgm_mutex_t codebook_index_mutex = VGM_MUTEX_INIT;
+
+/* finds the id of the Vorbis codebook at iw's position, and skips it */
+static int ogg2ww_codebook_library_find(vgm_bitstream * iw, uint32_t * codebook_id) {
+    uint8_t cbuf[0x8000]; /* Vorbis codebook from the setup */
+    uint8_t lbuf[0x8000]; /* Vorbis codebook from the library */
+    vgm_bitstream cw;
+    uint64_t hash;
+    size_t bits;
+    int i, found = 0;
+
+    /* copy to a byte-aligned buffer, to compare with rebuilt codebooks */
+    memset(cbuf, 0, sizeof(cbuf));
+    cw.buf = cbuf;
+    cw.bufsize = sizeof(cbuf);
+    cw.b_off = 0;
+    cw.mode = BITSTREAM_VORBIS;
+
+    if (!ww2ogg_codebook_library_copy(&cw, iw)) goto fail;
+    bits = cw.b_off;
+    hash = hash_fnv1a(VGM_HASH_INIT, cbuf, (bits + 7) / 8);
+
+    vgm_mutex_lock(&codebook_index_mutex);
+
+    if (codebook_index_count < 0) {
+        memset(lbuf, 0, sizeof(lbuf));
+
+        for (i = 0; i < WWISE_CODEBOOK_ID_MAX; i++) {
+            size_t lbits = ogg2ww_codebook_rebuild_by_id(lbuf, sizeof(lbuf), i);
+            if (!lbits) break; /* ids are contiguous */
+
+            codebook_index[i].hash = hash_fnv1a(VGM_HASH_INIT, lbuf, (lbits + 7) / 8);
+            codebook_index[i].bits = lbits;
+            memset(lbuf, 0, (lbits + 7) / 8);
         }
+        codebook_index_count = i;
     }
 
-    // this can be used if the lists contained a 1:1 dump of the codebook files
-#if 0
-    if (wvc == NULL) goto fail;
-    /* find codebook and copy to buffer */
-    {
-        off_t table_start, codebook_offset;
-        size_t codebook_size;
-        int codebook_count;
+    for (i = 0; i < codebook_index_count; i++) {
+        if (codebook_index[i].bits != bits || codebook_index[i].hash != hash)
+            continue;
+
+        /* hashes may collide */
+        memset(lbuf, 0, (bits + 7) / 8);
+        if (ogg2ww_codebook_rebuild_by_id(lbuf, sizeof(lbuf), i) != bits)
+            continue;
+        if (memcmp(lbuf, cbuf, (bits + 7) / 8) != 0)
+            continue;
+
+        *codebook_id = i;
+        found = 1;
+        break;
+    }
 
-        /* at the end of the WVC is an offset table, and we need to find codebook id (number) offset */
-        table_start = get_32bitLE(wvc + wvc_size - 4); /* last offset */
-        codebook_count = ((wvc_size - table_start) / 4) - 1;
-        if (codebook_id >= codebook_count) goto fail;
+    vgm_mutex_unlock(&codebook_index_mutex);
 
-        codebook_offset = get_32bitLE(wvc + table_start + codebook_id*4);
-        codebook_size   = get_32bitLE(wvc + table_start + codebook_id*4 + 4) - codebook_offset;
-        if (codebook_size > bufsize) goto fail;
+    return found;
+fail:
+    return 0;
+}
+
+/* rebuilds an aoTuV 6.03 library codebook into buf (must be zeroed), returns its size in bits */
+static size_t ogg2ww_codebook_rebuild_by_id(uint8_t * buf, size_t bufsize, uint32_t codebook_id) {
+    const uint8_t * cb;
+    size_t cb_size = 0;
+    vgm_bitstream ow, iw;
+
+    cb = load_wvc_array(codebook_id, WWV_AOTUV603_CODEBOOKS, &cb_size);
+    if (!cb || cb_size == 0) goto fail;
+
+    ow.buf = buf;
+    ow.bufsize = bufsize;
+    ow.b_off = 0;
+    ow.mode = BITSTREAM_VORBIS;
 
-        memcpy(buf, wvc+codebook_offset, codebook_size);
+    iw.buf = (uint8_t *)cb; /* only read */
+    iw.bufsize = cb_size;
+    iw.b_off = 0;
+    iw.mode = BITSTREAM_VORBIS;
 
-        return codebook_size;
+    if (!ww2ogg_codebook_library_rebuild(&ow, &iw, cb_size, NULL)) goto fail;
+
+    return ow.b_off;
+fail:
+    return 0;
+}
+
+static int ogg2ww_buffer_put(ogg2ww_buffer * b, const uint8_t * buf, size_t size) {
+    if (b->size + size > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity * 2 : 0x10000;
+        uint8_t * new_buf;
+
+        while (capacity < b->size + size)
+            capacity *= 2;
+        new_buf = realloc(b->buf, capacity);
+        if (!new_buf) return 0;
+
+        b->buf = new_buf;
+        b->capacity = capacity;
     }
-#endif
+
+    memcpy(b->buf + b->size, buf, size);
+    b->size += size;
+    return 1;
+}
+
+/* Builds a newer Wwise RIFF header (see wwise.c), up to the "data" chunk. Unknown fields are left empty. */
+static size_t ogg2ww_build_header(uint8_t * buf, size_t bufsize, int channels, int sample_rate, int bitrate, int32_t num_samples,
+        size_t data_size, size_t audio_offset, size_t max_packet_size, int blocksize_0_exp, int blocksize_1_exp) {
+    size_t bytes = 0x0c + 0x08 + 0x42 + 0x08;
+    uint8_t * fmt = buf + 0x14;
+
+    if (bytes > bufsize) return 0;
+    memset(buf, 0, bytes);
+
+    memcpy     (buf+0x00, "RIFF", 4);
+    put_32bitLE(buf+0x04, bytes - 0x08 + data_size + (data_size % 2));
+    memcpy     (buf+0x08, "WAVE", 4);
+    memcpy     (buf+0x0c, "fmt ", 4);
+    put_32bitLE(buf+0x10, 0x42);
+
+    put_16bitLE(fmt+0x00, 0xFFFF);          /* format (Vorbis) */
+    put_16bitLE(fmt+0x02, channels);
+    put_32bitLE(fmt+0x04, sample_rate);
+    put_32bitLE(fmt+0x08, bitrate / 8);     /* bytes per sec */
+    put_16bitLE(fmt+0x0c, 0);               /* block_align (always 0) */
+    put_16bitLE(fmt+0x0e, 0);               /* bits_per_sample (always 0) */
+    put_16bitLE(fmt+0x10, 0x30);            /* extra size */
+    /* 0x12: flag, 0x14: channel config */
+    put_32bitLE(fmt+0x18, num_samples);
+    put_32bitLE(fmt+0x1c, audio_offset);    /* data start after setup */
+    put_32bitLE(fmt+0x20, data_size);       /* data end */
+    /* 0x24/0x26: unknown */
+    put_32bitLE(fmt+0x28, 0);               /* setup offset (no seek table) */
+    put_32bitLE(fmt+0x2c, audio_offset);
+    put_16bitLE(fmt+0x30, max_packet_size);
+    /* 0x32: unknown, 0x34/0x38: decoder alloc sizes?, 0x3c: codebook hash? */
+    put_8bit   (fmt+0x40, blocksize_1_exp); /* small */
+    put_8bit   (fmt+0x41, blocksize_0_exp); /* big */
+
+    memcpy     (buf+0x56, "data", 4);
+    put_32bitLE(buf+0x5a, data_size);
+
+    return bytes;
+}
+
+
+/* **************************************************************************** */
+/* INTERNAL UTILS                                                               */
+/* **************************************************************************** */
+
+/* finds a Wwise Vorbis Codebook (wvc) referenced by ID, either in the precompiled list or in an
+ * external (dir/).wvc file, and returns a pointer to it and its size */
+static const uint8_t * load_wvc(uint32_t codebook_id, wwise_setup_t setup_type, STREAMFILE *streamFile, size_t * cb_size) {
+    const uint8_t * cb;
+
+    /* try to locate from the precompiled list */
+    cb = load_wvc_array(codebook_id, setup_type, cb_size);
+    if (cb)
+        return cb;
+
+    /* try to load from external file (ignoring type, just use file if found) */
+    cb = vorbis_custom_library_find(streamFile, ".wvc", VORBIS_LIBRARY_WVC, codebook_id, cb_size);
+    if (cb)
+        return cb;
+
+    /* not found */
+    VGM_LOG("Wwise Vorbis: codebook_id %04x not found\n", codebook_id);
+    return NULL;
+}
+
+static const uint8_t * load_wvc_array(uint32_t codebook_id, wwise_setup_t setup_type, size_t * cb_size) {
+#if WWISE_VORBIS_USE_PRECOMPILED_WVC
+    int list_length;
+    const wvc_info * wvc_list;
+
+    switch (setup_type) {
+        case WWV_EXTERNAL_CODEBOOKS:
+            wvc_list = wvc_list_standard;
+            list_length = sizeof(wvc_list_standard) / sizeof(wvc_info);
+            break;
+        case WWV_AOTUV603_CODEBOOKS:
+            wvc_list = wvc_list_aotuv603;
+            list_length = sizeof(wvc_list_aotuv603) / sizeof(wvc_info);
+            break;
+        default:
+            goto fail;
+    }
+
+    /* lists are indexed by id */
+    if (codebook_id >= list_length || wvc_list[codebook_id].id != codebook_id)
+        goto fail;
+
+    *cb_size = wvc_list[codebook_id].size;
+    return wvc_list[codebook_id].codebook;
 
 fail:
 #endif
-    return 0;
+    return NULL;
 }
 
 #endif
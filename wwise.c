@@ -15,6 +15,7 @@ typedef struct {
     int truncated;
 
     /* chunks references */
+    chunk_directory chunks;
     off_t fmt_offset;
     size_t fmt_size;
     off_t data_offset;
@@ -69,6 +70,9 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
 
     ww.file_size = streamFile->get_size(streamFile);
 
+    /* read all chunks at once, as several are needed */
+    if (!build_chunk_directory(&ww.chunks, streamFile, first_offset, ww.big_endian)) goto fail;
+
 #if 0
     /* sometimes uses a RIFF size that doesn't count chunks/sizes, has LE size in RIFX, or is just wrong...? */
     if (4+4+read_32bit(0x04,streamFile) != ww.file_size) {
@@ -82,7 +86,7 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
         off_t fact_offset;
         size_t fact_size;
 
-        if (find_chunk(streamFile, 0x66616374,first_offset,0, &fact_offset,&fact_size, 0, 0)) { /* "fact" */
+        if (find_chunk_directory(&ww.chunks, 0x66616374, &fact_offset,&fact_size)) { /* "fact" */
             if (fact_size == 0x10 && read_32bitBE(fact_offset+0x04, streamFile) == 0x4C794E20) /* "LyN " */
                 goto fail; /* parsed elsewhere */
             /* Wwise doesn't use "fact", though */
@@ -96,8 +100,8 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
         size_t loop_size;
 
         /* find basic chunks */
-        if (!find_chunk(streamFile, 0x666d7420,first_offset,0, &ww.fmt_offset,&ww.fmt_size, ww.big_endian, 0)) goto fail; /*"fmt "*/
-        if (!find_chunk(streamFile, 0x64617461,first_offset,0, &ww.data_offset,&ww.data_size, ww.big_endian, 0)) goto fail; /*"data"*/
+        if (!find_chunk_directory(&ww.chunks, 0x666d7420, &ww.fmt_offset,&ww.fmt_size)) goto fail; /*"fmt "*/
+        if (!find_chunk_directory(&ww.chunks, 0x64617461, &ww.data_offset,&ww.data_size)) goto fail; /*"data"*/
 
         /* base fmt */
         if (ww.fmt_size < 0x12) goto fail;
@@ -113,7 +117,7 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
 	  ww.extra_size   = (uint16_t)read_16bit(ww.fmt_offset+0x10,streamFile);
 
         /* find loop info */
-        if (find_chunk(streamFile, 0x736D706C,first_offset,0, &loop_offset,&loop_size, ww.big_endian, 0)) { /*"smpl". common */
+        if (find_chunk_directory(&ww.chunks, 0x736D706C, &loop_offset,&loop_size)) { /*"smpl". common */
 	  if (loop_size >= 0x34
                     && read_32bit(loop_offset+0x1c, streamFile)==1        /*loop count*/
                     && read_32bit(loop_offset+0x24+4, streamFile)==0) {
@@ -123,7 +127,7 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
                 //todo fix repeat looping
             }
         }
-        //else if (find_chunk(streamFile, 0x4C495354,first_offset,0, &loop_offset,&loop_size, ww.big_endian, 0)) { /*"LIST", common */
+        //else if (find_chunk_directory(&ww.chunks, 0x4C495354, &loop_offset,&loop_size)) { /*"LIST", common */
         //    /* usually contains "cue"s with sample positions for events (ex. Platinum Games) but no real looping info */
         //}
 
@@ -206,7 +210,7 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
             if (ww.block_align != 0 || ww.bits_per_sample != 0) goto fail; /* always 0 for Worbis */
 
             /* autodetect format (field are mostly common, see the end of the file) */
-            if (find_chunk(streamFile, 0x766F7262,first_offset,0, &vorb_offset,&vorb_size, ww.big_endian, 0)) { /*"vorb"*/
+            if (find_chunk_directory(&ww.chunks, 0x766F7262, &vorb_offset,&vorb_size)) { /*"vorb"*/
                 /* older Wwise (~<2012) */
 
                 switch(vorb_size) {
@@ -249,6 +253,10 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
                     cfg.blocksize_0_exp = read_8bit(vorb_offset + block_offsets + 0x01, streamFile); /* big */
                 }
                 ww.data_size -= audio_offset;
+                cfg.stream_offset = start_offset + audio_offset;
+                cfg.stream_size = ww.data_size;
+                cfg.seek_table_offset = start_offset;
+                cfg.seek_table_size = setup_offset; /* table goes from data start to setup */
 
                 /* detect setup type:
                  * - full inline: ~2009, ex. The King of Fighters XII X360, The Saboteur PC
@@ -302,6 +310,10 @@ VGMSTREAM * init_vgmstream_wwise(STREAMFILE *streamFile) {
                 cfg.blocksize_1_exp = read_8bit(extra_offset + block_offsets + 0x00, streamFile); /* small */
                 cfg.blocksize_0_exp = read_8bit(extra_offset + block_offsets + 0x01, streamFile); /* big */
                 ww.data_size -= audio_offset;
+                cfg.stream_offset = start_offset + audio_offset;
+                cfg.stream_size = ww.data_size;
+                cfg.seek_table_offset = start_offset;
+                cfg.seek_table_size = setup_offset; /* table goes from data start to setup */
 
                 /* Normal packets are used rarely (ex. Oddworld New 'n' Tasty! PSV). They are hard to detect (decoding
                  * will mostly work with garbage results) but we'll try. Setup size and "fmt" bitrate fields may matter too. */